@@ -8,11 +8,29 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+// Uniforms are looked up by a 32 bit FNV-1a hash of their name. Written as
+// constexpr so ids for names known at compile time cost nothing at runtime.
+typedef unsigned int UniformId;
+constexpr UniformId uniform_id(const char *name, UniformId hash = 2166136261u)
+{
+    return *name ? uniform_id(name + 1, (hash ^ (unsigned char)*name) * 16777619u) : hash;
+}
+
+// Binding point of the per-frame uniform block ("Frame"); every program that
+// declares the block is pointed at it when linked.
+const unsigned int FRAME_BLOCK_BINDING = 0;
 
 class Shader
 {
 public:
     unsigned int ID;
+    // an empty shader, for build() to compile later
+    // ------------------------------------------------------------------------
+    Shader() : ID(0) {}
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
@@ -57,8 +75,12 @@ public:
         {
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
         }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
+        build(vertexCode.c_str(), fragmentCode.c_str(), geometryPath != nullptr ? geometryCode.c_str() : nullptr);
+    }
+    // compiles and links the program from source already in memory
+    // ------------------------------------------------------------------------
+    void build(const char* vShaderCode, const char* fShaderCode, const char* gShaderCode = nullptr)
+    {
         // 2. compile shaders
         unsigned int vertex, fragment;
         // vertex shader
@@ -72,10 +94,9 @@ public:
         glCompileShader(fragment);
         checkCompileErrors(fragment, "FRAGMENT");
         // if geometry shader is given, compile geometry shader
-        unsigned int geometry;
-        if(geometryPath != nullptr)
+        unsigned int geometry = 0;
+        if(gShaderCode != nullptr)
         {
-            const char * gShaderCode = geometryCode.c_str();
             geometry = glCreateShader(GL_GEOMETRY_SHADER);
             glShaderSource(geometry, 1, &gShaderCode, NULL);
             glCompileShader(geometry);
@@ -85,16 +106,16 @@ public:
         ID = glCreateProgram();
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
-        if(geometryPath != nullptr)
+        if(gShaderCode != nullptr)
             glAttachShader(ID, geometry);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
         // delete the shaders as they're linked into our program now and no longer necessery
         glDeleteShader(vertex);
         glDeleteShader(fragment);
-        if(geometryPath != nullptr)
+        if(gShaderCode != nullptr)
             glDeleteShader(geometry);
-
+        reflect();
     }
     // activate the shader
     // ------------------------------------------------------------------------
@@ -102,66 +123,189 @@ public:
     { 
         glUseProgram(ID); 
     }
-    // utility uniform functions
+    // uniform setters by precomputed id. They assume this shader is the one in
+    // use, do nothing for uniforms the program doesn't have, and skip the
+    // upload when the uniform already holds the value.
+    // ------------------------------------------------------------------------
+    void set(UniformId id, bool value)
+    {
+        set(id, (int)value);
+    }
+    void set(UniformId id, int value)
+    {
+        Uniform *u = changed(id, &value, sizeof(value));
+        if(u)
+            glUniform1i(u->location, value);
+    }
+    void set(UniformId id, float value)
+    {
+        Uniform *u = changed(id, &value, sizeof(value));
+        if(u)
+            glUniform1f(u->location, value);
+    }
+    void set(UniformId id, const glm::vec2 &value)
+    {
+        Uniform *u = changed(id, &value[0], sizeof(value));
+        if(u)
+            glUniform2fv(u->location, 1, &value[0]);
+    }
+    void set(UniformId id, const glm::vec3 &value)
+    {
+        Uniform *u = changed(id, &value[0], sizeof(value));
+        if(u)
+            glUniform3fv(u->location, 1, &value[0]);
+    }
+    void set(UniformId id, const glm::vec4 &value)
+    {
+        Uniform *u = changed(id, &value[0], sizeof(value));
+        if(u)
+            glUniform4fv(u->location, 1, &value[0]);
+    }
+    void set(UniformId id, const glm::mat2 &mat)
+    {
+        Uniform *u = changed(id, &mat[0][0], sizeof(mat));
+        if(u)
+            glUniformMatrix2fv(u->location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void set(UniformId id, const glm::mat3 &mat)
+    {
+        Uniform *u = changed(id, &mat[0][0], sizeof(mat));
+        if(u)
+            glUniformMatrix3fv(u->location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void set(UniformId id, const glm::mat4 &mat)
+    {
+        Uniform *u = changed(id, &mat[0][0], sizeof(mat));
+        if(u)
+            glUniformMatrix4fv(u->location, 1, GL_FALSE, &mat[0][0]);
+    }
+    // utility uniform functions, by name; these hash the name on every call
+    // so keep them out of the frame loop
     // ------------------------------------------------------------------------
-    void setBool(const std::string &name, bool value) const
+    void setBool(const std::string &name, bool value)
     {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        set(uniform_id(name.c_str()), value); 
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string &name, int value) const
+    void setInt(const std::string &name, int value)
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        set(uniform_id(name.c_str()), value); 
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string &name, float value) const
+    void setFloat(const std::string &name, float value)
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        set(uniform_id(name.c_str()), value); 
     }
     // ------------------------------------------------------------------------
-    void setVec2(const std::string &name, const glm::vec2 &value) const
+    void setVec2(const std::string &name, const glm::vec2 &value)
     { 
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        set(uniform_id(name.c_str()), value); 
     }
-    void setVec2(const std::string &name, float x, float y) const
+    void setVec2(const std::string &name, float x, float y)
     { 
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); 
+        set(uniform_id(name.c_str()), glm::vec2(x, y)); 
     }
     // ------------------------------------------------------------------------
-    void setVec3(const std::string &name, const glm::vec3 &value) const
+    void setVec3(const std::string &name, const glm::vec3 &value)
     { 
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        set(uniform_id(name.c_str()), value); 
     }
-    void setVec3(const std::string &name, float x, float y, float z) const
+    void setVec3(const std::string &name, float x, float y, float z)
     { 
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+        set(uniform_id(name.c_str()), glm::vec3(x, y, z)); 
     }
     // ------------------------------------------------------------------------
-    void setVec4(const std::string &name, const glm::vec4 &value) const
+    void setVec4(const std::string &name, const glm::vec4 &value)
     { 
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+        set(uniform_id(name.c_str()), value); 
     }
     void setVec4(const std::string &name, float x, float y, float z, float w) 
     { 
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+        set(uniform_id(name.c_str()), glm::vec4(x, y, z, w)); 
     }
     // ------------------------------------------------------------------------
-    void setMat2(const std::string &name, const glm::mat2 &mat) const
+    void setMat2(const std::string &name, const glm::mat2 &mat)
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        set(uniform_id(name.c_str()), mat);
     }
     // ------------------------------------------------------------------------
-    void setMat3(const std::string &name, const glm::mat3 &mat) const
+    void setMat3(const std::string &name, const glm::mat3 &mat)
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        set(uniform_id(name.c_str()), mat);
     }
     // ------------------------------------------------------------------------
-    void setMat4(const std::string &name, const glm::mat4 &mat) const
+    void setMat4(const std::string &name, const glm::mat4 &mat)
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        set(uniform_id(name.c_str()), mat);
     }
 
 private:
+    // one active uniform and the last value uploaded to it
+    struct Uniform
+    {
+        UniformId id;
+        GLint location;
+        bool uploaded;
+        unsigned char value[sizeof(glm::mat4)];
+
+        bool operator<(const Uniform &other) const { return id < other.id; }
+    };
+    // sorted by id
+    std::vector<Uniform> uniforms;
+
+    // build the uniform table from what the linker kept, and hook the
+    // program's uniform blocks up to their binding points
+    // ------------------------------------------------------------------------
+    void reflect()
+    {
+        GLint count = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        for(GLint i = 0; i < count; i++)
+        {
+            GLchar name[256];
+            GLsizei length;
+            GLint size;
+            GLenum type;
+            glGetActiveUniform(ID, i, sizeof(name), &length, &size, &type, name);
+            // arrays are reported as "name[0]"; they go by their plain name
+            if(length > 3 && strcmp(name + length - 3, "[0]") == 0)
+                name[length - 3] = '\0';
+            GLint location = glGetUniformLocation(ID, name);
+            if(location < 0)
+                continue; // lives in a uniform block
+            Uniform u;
+            u.id = uniform_id(name);
+            u.location = location;
+            u.uploaded = false;
+            uniforms.push_back(u);
+        }
+        std::sort(uniforms.begin(), uniforms.end());
+        for(size_t i = 1; i < uniforms.size(); i++)
+        {
+            if(uniforms[i].id == uniforms[i - 1].id)
+                std::cout << "ERROR::SHADER::UNIFORM_ID_COLLISION in program " << ID << std::endl;
+        }
+
+        GLuint frame = glGetUniformBlockIndex(ID, "Frame");
+        if(frame != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, frame, FRAME_BLOCK_BINDING);
+    }
+    // the uniform if it exists and `value` differs from what it holds, after
+    // recording `value` as uploaded; NULL when there is nothing to do
+    // ------------------------------------------------------------------------
+    Uniform *changed(UniformId id, const void *value, size_t size)
+    {
+        Uniform key;
+        key.id = id;
+        std::vector<Uniform>::iterator u = std::lower_bound(uniforms.begin(), uniforms.end(), key);
+        if(u == uniforms.end() || u->id != id)
+            return NULL;
+        if(u->uploaded && memcmp(u->value, value, size) == 0)
+            return NULL;
+        memcpy(u->value, value, size);
+        u->uploaded = true;
+        return &*u;
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
@@ -188,4 +332,35 @@ private:
         }
     }
 };
+
+// A uniform buffer holding a std140 block that several programs share, such
+// as the per-frame globals. update() only touches the buffer when the
+// contents changed.
+class UniformBuffer
+{
+public:
+    unsigned int ID;
+
+    void create(unsigned int binding, size_t size)
+    {
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, ID);
+        contents.clear();
+    }
+    void update(const void *data, size_t size)
+    {
+        if(contents.size() == size && memcmp(&contents[0], data, size) == 0)
+            return;
+        contents.assign((const unsigned char *)data, (const unsigned char *)data + size);
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+private:
+    std::vector<unsigned char> contents;
+};
 #endif
\ No newline at end of file
@@ -0,0 +1,463 @@
+#include "texture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+size_t TextureArray::bytes() const
+{
+    size_t total = 0;
+    for (size_t i = 0; i < levels.size(); i++)
+        total += levels[i].size();
+    return total;
+}
+
+// sRGB <-> linear light, for averaging texels
+static float to_linear(unsigned char c)
+{
+    static float table[256];
+    static bool built = false;
+    if (!built)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            float s = i / 255.0f;
+            table[i] = s <= 0.04045f ? s / 12.92f : powf((s + 0.055f) / 1.055f, 2.4f);
+        }
+        built = true;
+    }
+    return table[c];
+}
+
+static unsigned char to_srgb(float l)
+{
+    float s = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+    return (unsigned char)std::min(255.0f, std::max(0.0f, s * 255.0f + 0.5f));
+}
+
+// one RGBA8 layer of half the size of src, clamped at odd edges
+static void downsample(const unsigned char *src, int sw, int sh, unsigned char *dst, int dw, int dh)
+{
+    for (int y = 0; y < dh; y++)
+    {
+        for (int x = 0; x < dw; x++)
+        {
+            float rgb[3] = {0.0f, 0.0f, 0.0f};
+            float alpha = 0.0f, plain[3] = {0.0f, 0.0f, 0.0f};
+            for (int t = 0; t < 4; t++)
+            {
+                int sx = std::min(2 * x + (t & 1), sw - 1);
+                int sy = std::min(2 * y + (t >> 1), sh - 1);
+                const unsigned char *p = src + (sy * sw + sx) * 4;
+                float a = p[3] / 255.0f;
+                for (int c = 0; c < 3; c++)
+                {
+                    rgb[c] += to_linear(p[c]) * a;
+                    plain[c] += to_linear(p[c]);
+                }
+                alpha += a;
+            }
+            unsigned char *q = dst + (y * dw + x) * 4;
+            for (int c = 0; c < 3; c++)
+                q[c] = to_srgb(alpha > 0.0f ? rgb[c] / alpha : plain[c] / 4.0f);
+            q[3] = (unsigned char)(alpha / 4.0f * 255.0f + 0.5f);
+        }
+    }
+}
+
+// BC3 (DXT5)
+// ----------
+
+static uint16_t pack565(const float c[3])
+{
+    int r = (int)(c[0] * 31.0f / 255.0f + 0.5f);
+    int g = (int)(c[1] * 63.0f / 255.0f + 0.5f);
+    int b = (int)(c[2] * 31.0f / 255.0f + 0.5f);
+    return (uint16_t)(r << 11 | g << 5 | b);
+}
+
+static void unpack565(uint16_t c, int out[3])
+{
+    out[0] = (c >> 11 & 31) * 255 / 31;
+    out[1] = (c >> 5 & 63) * 255 / 63;
+    out[2] = (c & 31) * 255 / 31;
+}
+
+// endpoints at the extremes of the block's colours along their principal
+// axis; transparent texels are left out, their colour is never seen
+static void encode_colour(const unsigned char block[16][4], unsigned char *out)
+{
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    int count = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        if (block[i][3] == 0)
+            continue;
+        for (int c = 0; c < 3; c++)
+            mean[c] += block[i][c];
+        count++;
+    }
+    bool all = count == 0;
+    if (all)
+    {
+        for (int i = 0; i < 16; i++)
+            for (int c = 0; c < 3; c++)
+                mean[c] += block[i][c];
+        count = 16;
+    }
+    for (int c = 0; c < 3; c++)
+        mean[c] /= count;
+
+    float cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}; // rr rg rb gg gb bb
+    for (int i = 0; i < 16; i++)
+    {
+        if (!all && block[i][3] == 0)
+            continue;
+        float d[3] = {block[i][0] - mean[0], block[i][1] - mean[1], block[i][2] - mean[2]};
+        cov[0] += d[0] * d[0];
+        cov[1] += d[0] * d[1];
+        cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1];
+        cov[4] += d[1] * d[2];
+        cov[5] += d[2] * d[2];
+    }
+    // power iteration for the axis
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int it = 0; it < 8; it++)
+    {
+        float n[3] = {cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                      cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                      cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]};
+        float len = std::max(std::max(fabsf(n[0]), fabsf(n[1])), fabsf(n[2]));
+        if (len == 0.0f)
+            break;
+        for (int c = 0; c < 3; c++)
+            axis[c] = n[c] / len;
+    }
+
+    float lo = 1e9f, hi = -1e9f;
+    for (int i = 0; i < 16; i++)
+    {
+        if (!all && block[i][3] == 0)
+            continue;
+        float t = (block[i][0] - mean[0]) * axis[0] + (block[i][1] - mean[1]) * axis[1] + (block[i][2] - mean[2]) * axis[2];
+        lo = std::min(lo, t);
+        hi = std::max(hi, t);
+    }
+    float axis_len2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    float e0[3], e1[3];
+    for (int c = 0; c < 3; c++)
+    {
+        e0[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * hi / axis_len2));
+        e1[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * lo / axis_len2));
+    }
+    uint16_t c0 = pack565(e0), c1 = pack565(e1);
+    // c0 > c1 selects four colours on every decoder
+    if (c0 < c1)
+        std::swap(c0, c1);
+
+    int palette[4][3];
+    unpack565(c0, palette[0]);
+    unpack565(c1, palette[1]);
+    for (int c = 0; c < 3; c++)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+    uint32_t indices = 0;
+    for (int i = 0; i < 16 && c0 != c1; i++)
+    {
+        int best = 0, best_error = 1 << 30;
+        for (int p = 0; p < 4; p++)
+        {
+            int dr = block[i][0] - palette[p][0], dg = block[i][1] - palette[p][1], db = block[i][2] - palette[p][2];
+            int error = dr * dr + dg * dg + db * db;
+            if (error < best_error)
+            {
+                best = p;
+                best_error = error;
+            }
+        }
+        indices |= (uint32_t)best << (2 * i);
+    }
+    out[0] = c0 & 0xff;
+    out[1] = c0 >> 8;
+    out[2] = c1 & 0xff;
+    out[3] = c1 >> 8;
+    for (int b = 0; b < 4; b++)
+        out[4 + b] = indices >> (8 * b) & 0xff;
+}
+
+static void encode_alpha(const unsigned char block[16][4], unsigned char *out)
+{
+    int a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; i++)
+    {
+        a0 = std::max(a0, (int)block[i][3]);
+        a1 = std::min(a1, (int)block[i][3]);
+    }
+    // a0 > a1 selects eight interpolated values
+    int palette[8] = {a0, a1};
+    for (int p = 1; p < 7; p++)
+        palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+    uint64_t indices = 0;
+    for (int i = 0; i < 16 && a0 != a1; i++)
+    {
+        int best = 0, best_error = 256;
+        for (int p = 0; p < 8; p++)
+        {
+            int error = abs(block[i][3] - palette[p]);
+            if (error < best_error)
+            {
+                best = p;
+                best_error = error;
+            }
+        }
+        indices |= (uint64_t)best << (3 * i);
+    }
+    out[0] = a0;
+    out[1] = a1;
+    for (int b = 0; b < 6; b++)
+        out[2 + b] = indices >> (8 * b) & 0xff;
+}
+
+// one RGBA8 layer as BC3 blocks, row by row from the bottom
+static void encode_bc3(const unsigned char *src, int width, int height, unsigned char *out)
+{
+    for (int by = 0; by < height; by += 4)
+    {
+        for (int bx = 0; bx < width; bx += 4)
+        {
+            unsigned char block[16][4];
+            for (int i = 0; i < 16; i++)
+            {
+                int x = std::min(bx + (i & 3), width - 1);
+                int y = std::min(by + (i >> 2), height - 1);
+                memcpy(block[i], src + (y * width + x) * 4, 4);
+            }
+            encode_alpha(block, out);
+            encode_colour(block, out + 8);
+            out += 16;
+        }
+    }
+}
+
+static size_t layer_bytes(int width, int height, bool compressed)
+{
+    if (compressed)
+        return (size_t)((width + 3) / 4) * ((height + 3) / 4) * 16;
+    return (size_t)width * height * 4;
+}
+
+bool build_texture_array(const std::vector<std::string> &paths, bool mipmaps, TextureCompression compression,
+                         TextureArray &out, std::string &error)
+{
+    int count = paths.size();
+    std::vector<unsigned char *> images(count);
+    std::vector<int> widths(count, 1), heights(count, 1);
+    out = TextureArray();
+    out.width = 1;
+    out.height = 1;
+    out.layers = count;
+    error.clear();
+    stbi_set_flip_vertically_on_load(true);
+    for (int i = 0; i < count; i++)
+    {
+        int channels;
+        images[i] = stbi_load(paths[i].c_str(), &widths[i], &heights[i], &channels, STBI_rgb_alpha);
+        if (!images[i])
+        {
+            error += "failed to load " + paths[i] + "\n";
+            widths[i] = heights[i] = 1;
+            continue;
+        }
+        out.width = std::max(out.width, widths[i]);
+        out.height = std::max(out.height, heights[i]);
+    }
+
+    // level 0, every layer
+    int w = out.width, h = out.height;
+    std::vector<unsigned char> level((size_t)w * h * 4 * count);
+    for (int i = 0; i < count; i++)
+    {
+        unsigned char *layer = &level[(size_t)w * h * 4 * i];
+        for (int y = 0; y < h; y++)
+        {
+            for (int x = 0; x < w; x++)
+            {
+                int sx = std::min(x, widths[i] - 1), sy = std::min(y, heights[i] - 1);
+                for (int c = 0; c < 4; c++)
+                    layer[(y * w + x) * 4 + c] = images[i] ? images[i][(sy * widths[i] + sx) * 4 + c] : 0;
+            }
+        }
+        out.extents.push_back((float)widths[i] / w);
+        out.extents.push_back((float)heights[i] / h);
+        stbi_image_free(images[i]);
+    }
+
+    bool compressed = compression == COMPRESS_BC3;
+    out.format = compressed ? TEX_COMPRESSED_SRGB_ALPHA_BC3 : TEX_SRGB8_ALPHA8;
+    for (int l = 0;; l++)
+    {
+        w = out.level_width(l);
+        h = out.level_height(l);
+        if (compressed)
+        {
+            size_t size = layer_bytes(w, h, true);
+            std::vector<unsigned char> blocks(size * count);
+            for (int i = 0; i < count; i++)
+                encode_bc3(&level[(size_t)w * h * 4 * i], w, h, &blocks[size * i]);
+            out.levels.push_back(blocks);
+        }
+        else
+            out.levels.push_back(level);
+
+        if (!mipmaps || (w == 1 && h == 1))
+            break;
+        int nw = out.level_width(l + 1), nh = out.level_height(l + 1);
+        std::vector<unsigned char> next((size_t)nw * nh * 4 * count);
+        for (int i = 0; i < count; i++)
+            downsample(&level[(size_t)w * h * 4 * i], w, h, &next[(size_t)nw * nh * 4 * i], nw, nh);
+        level.swap(next);
+    }
+    return error.empty();
+}
+
+// KTX 1
+// -----
+
+static const unsigned char ktx_identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+static const char *extents_key = "jetpack.extents";
+
+struct KtxHeader
+{
+    uint32_t endianness;
+    uint32_t type;
+    uint32_t type_size;
+    uint32_t format;
+    uint32_t internal_format;
+    uint32_t base_internal_format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t array_elements;
+    uint32_t faces;
+    uint32_t mip_levels;
+    uint32_t key_value_bytes;
+};
+
+static size_t padding(size_t size) { return (4 - size % 4) % 4; }
+
+bool write_ktx(const std::string &path, const TextureArray &texture, std::string &error)
+{
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+    {
+        error = "cannot write " + path;
+        return false;
+    }
+    static const unsigned char zeros[4] = {0, 0, 0, 0};
+    uint32_t value_bytes = texture.extents.size() * sizeof(float);
+    uint32_t pair_bytes = strlen(extents_key) + 1 + value_bytes;
+
+    KtxHeader header;
+    header.endianness = 0x04030201;
+    header.type = texture.compressed() ? 0 : TEX_UNSIGNED_BYTE;
+    header.type_size = 1;
+    header.format = texture.compressed() ? 0 : TEX_RGBA;
+    header.internal_format = texture.format;
+    header.base_internal_format = TEX_RGBA;
+    header.width = texture.width;
+    header.height = texture.height;
+    header.depth = 0;
+    header.array_elements = texture.layers;
+    header.faces = 1;
+    header.mip_levels = texture.levels.size();
+    header.key_value_bytes = sizeof(uint32_t) + pair_bytes + padding(pair_bytes);
+
+    fwrite(ktx_identifier, 1, sizeof(ktx_identifier), file);
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(&pair_bytes, sizeof(pair_bytes), 1, file);
+    fwrite(extents_key, 1, strlen(extents_key) + 1, file);
+    fwrite(texture.extents.data(), 1, value_bytes, file);
+    fwrite(zeros, 1, padding(pair_bytes), file);
+    for (size_t l = 0; l < texture.levels.size(); l++)
+    {
+        uint32_t size = texture.levels[l].size();
+        fwrite(&size, sizeof(size), 1, file);
+        fwrite(texture.levels[l].data(), 1, size, file);
+        fwrite(zeros, 1, padding(size), file);
+    }
+    bool written = !ferror(file);
+    fclose(file);
+    if (!written)
+        error = "cannot write " + path;
+    return written;
+}
+
+bool read_ktx(const std::string &path, TextureArray &texture, std::string &error)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    unsigned char identifier[12];
+    KtxHeader header;
+    bool valid = fread(identifier, sizeof(identifier), 1, file) == 1 &&
+                 memcmp(identifier, ktx_identifier, sizeof(identifier)) == 0 &&
+                 fread(&header, sizeof(header), 1, file) == 1 &&
+                 header.endianness == 0x04030201 && header.faces == 1 && header.depth == 0 &&
+                 header.array_elements > 0 && header.mip_levels > 0 &&
+                 (header.internal_format == TEX_SRGB8_ALPHA8 || header.internal_format == TEX_COMPRESSED_SRGB_ALPHA_BC3);
+
+    texture = TextureArray();
+    if (valid)
+    {
+        texture.format = header.internal_format;
+        texture.width = header.width;
+        texture.height = header.height;
+        texture.layers = header.array_elements;
+
+        std::vector<unsigned char> pairs(header.key_value_bytes);
+        valid = fread(pairs.data(), 1, pairs.size(), file) == pairs.size();
+        for (size_t at = 0; valid && at + sizeof(uint32_t) <= pairs.size();)
+        {
+            uint32_t size;
+            memcpy(&size, &pairs[at], sizeof(size));
+            at += sizeof(size);
+            if (at + size > pairs.size())
+                break;
+            const char *key = (const char *)&pairs[at];
+            size_t key_size = strnlen(key, size) + 1;
+            if (key_size <= size && strcmp(key, extents_key) == 0)
+            {
+                texture.extents.resize((size - key_size) / sizeof(float));
+                memcpy(texture.extents.data(), &pairs[at + key_size], texture.extents.size() * sizeof(float));
+            }
+            at += size + padding(size);
+        }
+        if (texture.extents.size() != (size_t)texture.layers * 2)
+            texture.extents.assign(texture.layers * 2, 1.0f);
+    }
+    for (uint32_t l = 0; valid && l < header.mip_levels; l++)
+    {
+        uint32_t size;
+        size_t expected = layer_bytes(texture.level_width(l), texture.level_height(l), texture.compressed()) * texture.layers;
+        valid = fread(&size, sizeof(size), 1, file) == 1 && size == expected;
+        if (!valid)
+            break;
+        texture.levels.push_back(std::vector<unsigned char>(size));
+        valid = fread(texture.levels.back().data(), 1, size, file) == size &&
+                fseek(file, padding(size), SEEK_CUR) == 0;
+    }
+    fclose(file);
+    if (!valid)
+        error = path + " is not a texture array this game can read";
+    return valid;
+}
@@ -0,0 +1,56 @@
+#ifndef ASSETS_TEXTURE_H
+#define ASSETS_TEXTURE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Everything in src/assets is free of GL so textures can be cooked offline
+// by the cook tool; the game only uploads what these functions produce.
+
+// GL enums the cooked data is tagged with
+const uint32_t TEX_SRGB8_ALPHA8 = 0x8C43;
+const uint32_t TEX_COMPRESSED_SRGB_ALPHA_BC3 = 0x8C4F; // EXT_texture_compression_s3tc + EXT_texture_sRGB
+const uint32_t TEX_RGBA = 0x1908;
+const uint32_t TEX_UNSIGNED_BYTE = 0x1401;
+
+enum TextureCompression
+{
+    COMPRESS_NONE,
+    COMPRESS_BC3, // DXT5, 4x4 blocks of 16 bytes: a quarter of the memory
+};
+
+// A 2D texture array with every mip level laid out exactly as GL takes it,
+// so uploading is one call per level with no conversion.
+struct TextureArray
+{
+    uint32_t format = TEX_SRGB8_ALPHA8; // internal format
+    int width = 0;
+    int height = 0;
+    int layers = 0;
+    std::vector<std::vector<unsigned char>> levels; // every layer of a level, level 0 first
+    std::vector<float> extents; // part of its layer each image covers, x then y per layer
+
+    bool compressed() const { return format == TEX_COMPRESSED_SRGB_ALPHA_BC3; }
+    int level_width(int level) const { return width >> level > 0 ? width >> level : 1; }
+    int level_height(int level) const { return height >> level > 0 ? height >> level : 1; }
+    size_t bytes() const;
+};
+
+// Decodes the images into one layer each, layers as large as the largest
+// image. A smaller image sits in the bottom left corner of its layer (rows
+// run bottom up, as GL reads them) with its edge texels repeated out to the
+// border, so filtering at its edge reads the same texels clamping would.
+// The mip levels are averaged in linear light and weighted by alpha, so
+// edges neither darken nor bleed the transparent colour in.
+// An image that fails to load leaves its layer transparent; false and
+// error say which.
+bool build_texture_array(const std::vector<std::string> &paths, bool mipmaps, TextureCompression compression,
+                         TextureArray &out, std::string &error);
+
+// KTX 1 files: the standard header, the layer extents under the
+// "jetpack.extents" key and every level's data.
+bool write_ktx(const std::string &path, const TextureArray &texture, std::string &error);
+bool read_ktx(const std::string &path, TextureArray &texture, std::string &error);
+
+#endif
@@ -0,0 +1,135 @@
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sim/batch.h"
+#include "sim/collision.h"
+#include "sim/thread_pool.h"
+
+using namespace std;
+
+// Plays N seeded headless games across a thread pool and prints one CSV
+// row per run on stdout; throughput goes to stderr.
+//
+//   ./batch --runs 10000 --threads 8 --seed 42 [--level 0] [--policy random] [--endless]
+//           [--levels ../levels/levels.txt]
+
+void usage()
+{
+    fprintf(stderr, "usage: batch [--runs N] [--threads T] [--seed S] [--level N] [--policy random|hover]\n"
+                    "             [--tick-rate HZ] [--max-distance D] [--endless] [--levels FILE]\n"
+                    "--runs is at least 1 and --tick-rate above 0\n"
+                    "--level 0 sweeps every level; --threads 0 uses every core\n"
+                    "--endless plays the endless track (up to --max-distance, 120 by default)\n");
+}
+
+// the whole argument as a whole number no smaller than `min`, or false
+bool parse_int(const char *text, int min, int &value)
+{
+    char *end;
+    errno = 0;
+    long long parsed = strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < min || parsed > INT_MAX)
+        return false;
+    value = (int)parsed;
+    return true;
+}
+
+// the whole argument as a finite number above zero, or false
+bool parse_positive(const char *text, double &value)
+{
+    char *end;
+    double parsed = strtod(text, &end);
+    if (end == text || *end != '\0' || !std::isfinite(parsed) || !(parsed > 0))
+        return false;
+    value = parsed;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    int runs = 1000;
+    int threads = 0;
+    unsigned long long seed = 1;
+    int level = 0;
+    RunConfig base;
+    vector<LevelDesc> levels = default_levels();
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        // a value that doesn't parse or is out of range falls through to usage()
+        if (arg == "--runs" && has_value && parse_int(argv[i + 1], 1, runs))
+            i++;
+        else if (arg == "--threads" && has_value && parse_int(argv[i + 1], 0, threads))
+            i++;
+        else if (arg == "--seed" && has_value)
+            seed = strtoull(argv[++i], NULL, 10);
+        else if (arg == "--level" && has_value && parse_int(argv[i + 1], 0, level))
+            i++;
+        else if (arg == "--policy" && has_value && parse_policy(argv[i + 1], base.policy))
+            i++;
+        else if (arg == "--tick-rate" && has_value && parse_positive(argv[i + 1], base.tick_rate))
+            i++;
+        else if (arg == "--max-distance" && has_value && parse_int(argv[i + 1], 0, base.max_distance))
+            i++;
+        else if (arg == "--endless")
+            base.endless = true;
+        else if (arg == "--levels" && has_value)
+        {
+            string error;
+            if (!load_levels(argv[++i], levels, error))
+            {
+                fprintf(stderr, "%s\n", error.c_str());
+                return 1;
+            }
+        }
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    // checked once every option is in, --levels may come after --level
+    if (level > (int)levels.size())
+    {
+        fprintf(stderr, "--level %d: there are only %d levels\n", level, (int)levels.size());
+        return 1;
+    }
+
+    base.levels = &levels;
+    vector<RunResult> results(runs);
+    ThreadPool pool(threads);
+
+    auto start = chrono::steady_clock::now();
+    for (int run = 0; run < runs; run++)
+    {
+        RunConfig config = base;
+        config.seed = run_seed(seed, run);
+        config.level = level > 0 ? level : run % levels.size() + 1;
+        pool.submit([config, run, &results] { results[run] = play_run(config); });
+    }
+    pool.wait();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long ticks = 0;
+    printf("run,seed,level,policy,distance,coins,ticks,cause\n");
+    for (int run = 0; run < runs; run++)
+    {
+        const RunResult &r = results[run];
+        printf("%d,%llu,%d,%s,%.3f,%d,%ld,%s\n", run, r.seed, r.level, policy_name(base.policy), r.distance, r.coins, r.ticks, r.cause);
+        ticks += r.ticks;
+    }
+
+    fprintf(stderr, "%d runs, %ld ticks in %.3fs on %u threads: %.0f ticks/s (%.0f per thread), %s collision kernel\n",
+            runs, ticks, elapsed, pool.size(), ticks / elapsed, ticks / elapsed / pool.size(), collision_kernel());
+    return 0;
+}
@@ -0,0 +1,237 @@
+#include "main.h"
+#include "bloom.h"
+#include "uniforms.h"
+
+void Bloom::create(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+
+    // one more level for every doubling of the height, so the smallest mip
+    // is the same fraction of the screen
+    int count = std::max(1, levels + (int)std::lround(std::log2((float)height / reference_height)));
+    int w = width, h = height;
+    for (int i = 0; i < count && w > 2 && h > 2; i++)
+    {
+        w /= 2;
+        h /= 2;
+        Mip mip;
+        mip.width = w;
+        mip.height = h;
+        glGenTextures(1, &mip.texture);
+        glBindTexture(GL_TEXTURE_2D, mip.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, w, h, 0, GL_RGBA, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        mips.push_back(mip);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    // areas are snapped to whole texels of the smallest mip, so they map to
+    // whole texels on every level; the 13 tap filters reach about two texels
+    // of the level they read, which adds up to two of the smallest one
+    grid = 1 << mips.size();
+    padding = 2 * grid;
+
+    // every pass draws to one framebuffer, only its attachment changes
+    glGenFramebuffers(1, &FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mips[0].texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer not complete!" << std::endl;
+    // from here on everything outside the areas being drawn stays black
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    for (size_t i = 0; i < mips.size(); i++)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mips[i].texture, 0);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    float quad[] = {
+        -1.0f, 1.0f, 0.0f, 1.0f,
+        -1.0f, -1.0f, 0.0f, 0.0f,
+        1.0f, -1.0f, 1.0f, 0.0f,
+
+        1.0f, -1.0f, 1.0f, 0.0f,
+        -1.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f};
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+size_t Bloom::bytes() const
+{
+    size_t texels = 0;
+    for (size_t i = 0; i < mips.size(); i++)
+        texels += mips[i].width * mips[i].height;
+    return texels * (format == GL_R11F_G11F_B10F ? 4 : 8);
+}
+
+static int floor_to(int x, int step)
+{
+    return (x >= 0 ? x : x - step + 1) / step * step;
+}
+
+void Bloom::glow(glm::vec2 lo, glm::vec2 hi)
+{
+    Area area;
+    area.x0 = floor_to((int)std::floor((lo.x + 1.0f) * 0.5f * width) - padding, grid);
+    area.y0 = floor_to((int)std::floor((lo.y + 1.0f) * 0.5f * height) - padding, grid);
+    area.x1 = floor_to((int)std::ceil((hi.x + 1.0f) * 0.5f * width) + padding + grid - 1, grid);
+    area.y1 = floor_to((int)std::ceil((hi.y + 1.0f) * 0.5f * height) + padding + grid - 1, grid);
+    area.x0 = std::max(area.x0, 0);
+    area.y0 = std::max(area.y0, 0);
+    area.x1 = std::min(area.x1, floor_to(width + grid - 1, grid));
+    area.y1 = std::min(area.y1, floor_to(height + grid - 1, grid));
+    // off screen
+    if (area.x0 >= area.x1 || area.y0 >= area.y1)
+        return;
+    // merged as they come, so thousands of zappers stay a handful of areas
+    glowing.push_back(area);
+    merge(glowing);
+}
+
+// Leaves no two areas overlapping, so no pixel is drawn twice in a pass,
+// and no more than max_areas of them: the pair that wastes the least when
+// joined into one box goes first.
+void Bloom::merge(std::vector<Area> &areas)
+{
+    for (;;)
+    {
+        int best_i = -1, best_j = -1;
+        long best_waste = 0;
+        for (size_t i = 0; i < areas.size(); i++)
+        {
+            for (size_t j = i + 1; j < areas.size(); j++)
+            {
+                const Area &a = areas[i], &b = areas[j];
+                bool overlap = a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1;
+                long joined = (long)(std::max(a.x1, b.x1) - std::min(a.x0, b.x0)) * (std::max(a.y1, b.y1) - std::min(a.y0, b.y0));
+                long waste = joined - (long)(a.x1 - a.x0) * (a.y1 - a.y0) - (long)(b.x1 - b.x0) * (b.y1 - b.y0);
+                if (overlap)
+                    waste = -1;
+                if (best_i < 0 || waste < best_waste)
+                {
+                    best_i = i;
+                    best_j = j;
+                    best_waste = waste;
+                }
+            }
+        }
+        if (best_i < 0 || (best_waste >= 0 && (int)areas.size() <= max_areas))
+            return;
+        Area &a = areas[best_i];
+        const Area &b = areas[best_j];
+        a.x0 = std::min(a.x0, b.x0);
+        a.y0 = std::min(a.y0, b.y0);
+        a.x1 = std::max(a.x1, b.x1);
+        a.y1 = std::max(a.y1, b.y1);
+        areas.erase(areas.begin() + best_j);
+    }
+}
+
+// the area on one level of the chain; areas are on the grid, so this is exact
+void Bloom::scissor(const Area &area, int level)
+{
+    int shift = level + 1;
+    int x0 = area.x0 >> shift, y0 = area.y0 >> shift;
+    int x1 = std::min(area.x1 >> shift, mips[level].width);
+    int y1 = std::min(area.y1 >> shift, mips[level].height);
+    glScissor(x0, y0, std::max(x1 - x0, 0), std::max(y1 - y0, 0));
+}
+
+unsigned int Bloom::apply(unsigned int bright, Shader &downShader, Shader &upShader)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glEnable(GL_SCISSOR_TEST);
+
+    // a bright pass drawn straight into the top level is that level already
+    size_t first = bright == mips[0].texture ? 1 : 0;
+
+    // the passes read a little past the edges of their areas and hdr.fs adds
+    // all of the top level, so what last frame left outside this frame's
+    // areas has to go
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    for (size_t i = first; i < mips.size() && !drawn.empty(); i++)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mips[i].texture, 0);
+        for (size_t a = 0; a < drawn.size(); a++)
+        {
+            scissor(drawn[a], i);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+    }
+    drawn = glowing;
+    pixels = 0;
+    for (size_t a = 0; a < drawn.size(); a++)
+        pixels += (drawn[a].x1 - drawn[a].x0) * (drawn[a].y1 - drawn[a].y0);
+
+    if (drawn.empty())
+    {
+        glDisable(GL_SCISSOR_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, width, height);
+        return 0;
+    }
+
+    glBindVertexArray(VAO);
+    glActiveTexture(GL_TEXTURE0);
+    glDisable(GL_BLEND);
+
+    // down: every pass writes all of its areas, no clears needed
+    downShader.use();
+    downShader.set(U_SOURCE, 0);
+    unsigned int source = first ? mips[0].texture : bright;
+    for (size_t i = first; i < mips.size(); i++)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mips[i].texture, 0);
+        glViewport(0, 0, mips[i].width, mips[i].height);
+        glBindTexture(GL_TEXTURE_2D, source);
+        for (size_t a = 0; a < drawn.size(); a++)
+        {
+            scissor(drawn[a], i);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+        }
+        source = mips[i].texture;
+    }
+
+    // up: blend the blurred level below into each level, weighted so every
+    // level ends up contributing equally and the glow keeps its energy
+    upShader.use();
+    upShader.set(U_SOURCE, 0);
+    upShader.set(U_RADIUS, glm::vec2(radius * height / width, radius));
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+    for (size_t i = mips.size() - 1; i > 0; i--)
+    {
+        float below = mips.size() - i; // levels already gathered in mips[i]
+        glBlendColor(0.0f, 0.0f, 0.0f, below / (below + 1.0f));
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mips[i - 1].texture, 0);
+        glViewport(0, 0, mips[i - 1].width, mips[i - 1].height);
+        glBindTexture(GL_TEXTURE_2D, mips[i].texture);
+        for (size_t a = 0; a < drawn.size(); a++)
+        {
+            scissor(drawn[a], i - 1);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+        }
+    }
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glDisable(GL_SCISSOR_TEST);
+    glBindVertexArray(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+    return mips[0].texture;
+}
@@ -0,0 +1,79 @@
+#include "main.h"
+#include "shader.h"
+
+#ifndef BLOOM_H
+#define BLOOM_H
+
+// Bloom over a mip chain instead of full resolution ping-pong blurs. The
+// bright pass is filtered down through progressively halved targets (the
+// first one is half the screen) with a 13 tap box filter, then back up with
+// a 3x3 tent, each level blended into the one above so the result holds the
+// tight glow of the upper levels and the wide glow of the lower ones.
+// levels is given for a 600 pixel high screen and create() adds or drops
+// levels for other heights, so together with radius (a fraction of the
+// screen height) the glow covers the same part of the screen at any
+// resolution.
+// Only what is drawn with blur on can glow, so each frame the scene reports
+// the boxes of those draws with glow() and every pass is scissored to them,
+// padded by how far the glow reaches. The bloom then costs as much as there
+// is glowing on screen, and nothing when there is none.
+class Bloom
+{
+public:
+    static const int reference_height = 600;
+    static const int max_areas = 4; // more boxes than this are merged
+
+    int levels = 5;
+    float radius = 0.004f;
+    GLenum format = GL_RGBA16F;
+
+    void create(int width, int height);
+    // the level the chain ends on, half the screen
+    unsigned int top() const { return mips[0].texture; }
+    int top_width() const { return mips[0].width; }
+    int top_height() const { return mips[0].height; }
+    size_t bytes() const;
+    // before the scene: forgets last frame's glowing boxes
+    void begin() { glowing.clear(); }
+    // box of a draw with blur on, in normalized device coordinates
+    void glow(glm::vec2 lo, glm::vec2 hi);
+    // blurs the bright pass, returns the texture to add to the scene or 0 if
+    // nothing glows; leaves the default framebuffer bound with a full screen
+    // viewport. bright may be top() itself, already at half resolution, in
+    // which case the first downsample is skipped.
+    unsigned int apply(unsigned int bright, Shader &downShader, Shader &upShader);
+
+    int pixels = 0; // screen pixels covered by the bloom last frame, for profiling
+
+private:
+    struct Mip
+    {
+        int width;
+        int height;
+        unsigned int texture;
+    };
+    // in screen pixels, x1 and y1 exclusive
+    struct Area
+    {
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+    };
+
+    void merge(std::vector<Area> &areas);
+    void scissor(const Area &area, int level);
+
+    int width;
+    int height;
+    int grid;    // one texel of the smallest mip, in screen pixels
+    int padding; // how far the glow reaches past a box, in screen pixels
+    unsigned int FBO;
+    unsigned int VAO;
+    unsigned int VBO;
+    std::vector<Mip> mips;
+    std::vector<Area> glowing; // this frame's boxes, as reported
+    std::vector<Area> drawn;   // the areas last apply() wrote to
+};
+
+#endif
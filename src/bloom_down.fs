@@ -0,0 +1,38 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D source;
+
+// 13 taps over a 4x4 texel footprint of the level above: a box of boxes,
+// which keeps moving highlights from flickering as they cross texels
+void main()
+{
+    vec2 texel = 1.0 / textureSize(source, 0);
+    float x = texel.x;
+    float y = texel.y;
+
+    vec3 a = texture(source, TexCoords + vec2(-2.0 * x, 2.0 * y)).rgb;
+    vec3 b = texture(source, TexCoords + vec2(0.0, 2.0 * y)).rgb;
+    vec3 c = texture(source, TexCoords + vec2(2.0 * x, 2.0 * y)).rgb;
+
+    vec3 d = texture(source, TexCoords + vec2(-2.0 * x, 0.0)).rgb;
+    vec3 e = texture(source, TexCoords).rgb;
+    vec3 f = texture(source, TexCoords + vec2(2.0 * x, 0.0)).rgb;
+
+    vec3 g = texture(source, TexCoords + vec2(-2.0 * x, -2.0 * y)).rgb;
+    vec3 h = texture(source, TexCoords + vec2(0.0, -2.0 * y)).rgb;
+    vec3 i = texture(source, TexCoords + vec2(2.0 * x, -2.0 * y)).rgb;
+
+    vec3 j = texture(source, TexCoords + vec2(-x, y)).rgb;
+    vec3 k = texture(source, TexCoords + vec2(x, y)).rgb;
+    vec3 l = texture(source, TexCoords + vec2(-x, -y)).rgb;
+    vec3 m = texture(source, TexCoords + vec2(x, -y)).rgb;
+
+    vec3 result = e * 0.125;
+    result += (a + c + g + i) * 0.03125;
+    result += (b + d + f + h) * 0.0625;
+    result += (j + k + l + m) * 0.125;
+    FragColor = vec4(result, 1.0);
+}
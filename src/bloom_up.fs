@@ -0,0 +1,25 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D source;
+uniform vec2 radius; // tent half width, in texture coordinates
+
+// 3x3 tent over the level below
+void main()
+{
+    float x = radius.x;
+    float y = radius.y;
+
+    vec3 result = texture(source, TexCoords).rgb * 4.0;
+    result += (texture(source, TexCoords + vec2(0.0, y)).rgb +
+               texture(source, TexCoords + vec2(-x, 0.0)).rgb +
+               texture(source, TexCoords + vec2(x, 0.0)).rgb +
+               texture(source, TexCoords + vec2(0.0, -y)).rgb) * 2.0;
+    result += texture(source, TexCoords + vec2(-x, y)).rgb +
+              texture(source, TexCoords + vec2(x, y)).rgb +
+              texture(source, TexCoords + vec2(-x, -y)).rgb +
+              texture(source, TexCoords + vec2(x, -y)).rgb;
+    FragColor = vec4(result / 16.0, 1.0);
+}
@@ -1,4 +1,6 @@
 #include "main.h"
+#include "sprites.h"
+#include "sim/world.h"
 
 #ifndef BOBBY_H
 #define BOBBY_H
@@ -6,17 +8,9 @@
 class Bobby
 {
 public:
-    unsigned int VAO;
-    void createVAO();
-    glm::mat4 trans;
-    Bobby() { trans = glm::mat4(1.0f); }
-    void fly();
-    void draw(unsigned int shaderProgram);
-    float abs_x;
-    float abs_y;
-    float y = 0;
-    float size_x;
-    float size_y;
+    void add(SpriteBatch &sprites, const PlayerState &state);
+    // corners of the drawn quad, in normalized device coordinates
+    void bounds(const PlayerState &state, glm::vec2 &lo, glm::vec2 &hi) const;
 };
 
 #endif
\ No newline at end of file
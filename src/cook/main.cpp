@@ -0,0 +1,62 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "assets/texture.h"
+
+using namespace std;
+
+// Lays images out as one GPU-ready texture array, mip levels included, and
+// writes it as a KTX file the game uploads without decoding anything.
+//
+//   ./cook -o ../textures/sprites.ktx [--compress bc3] [--no-mipmaps] background.jpg player.png zapper.png
+
+void usage()
+{
+    fprintf(stderr, "usage: cook -o OUT.ktx [--compress none|bc3] [--no-mipmaps] IMAGE...\n"
+                    "each image becomes one layer, in the order given\n");
+}
+
+int main(int argc, char **argv)
+{
+    string output;
+    TextureCompression compression = COMPRESS_NONE;
+    bool mipmaps = true;
+    vector<string> images;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-o" && has_value)
+            output = argv[++i];
+        else if (arg == "--compress" && has_value && (strcmp(argv[i + 1], "none") == 0 || strcmp(argv[i + 1], "bc3") == 0))
+            compression = strcmp(argv[++i], "bc3") == 0 ? COMPRESS_BC3 : COMPRESS_NONE;
+        else if (arg == "--no-mipmaps")
+            mipmaps = false;
+        else if (arg[0] != '-')
+            images.push_back(arg);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (output.empty() || images.empty())
+    {
+        usage();
+        return 1;
+    }
+
+    TextureArray texture;
+    string error;
+    if (!build_texture_array(images, mipmaps, compression, texture, error) || !write_ktx(output, texture, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    fprintf(stderr, "%s: %d layers of %dx%d, %d levels, %zu KB\n", output.c_str(), texture.layers,
+            texture.width, texture.height, (int)texture.levels.size(), texture.bytes() / 1024);
+    return 0;
+}
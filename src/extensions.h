@@ -0,0 +1,21 @@
+#include "main.h"
+
+#ifndef EXTENSIONS_H
+#define EXTENSIONS_H
+
+#include <cstring>
+
+// whether the context lists the extension, for features past GL 3.3
+inline bool has_extension(const char *name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        if (strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), name) == 0)
+            return true;
+    }
+    return false;
+}
+
+#endif
@@ -6,7 +6,11 @@ in vec2 TexCoords;
 uniform sampler2D scene;
 uniform sampler2D bloomBlur;
 uniform bool bloom;
-uniform float exposure;
+layout (std140) uniform Frame
+{
+    mat4 projection;
+    float exposure;
+};
 
 void main()
 {             
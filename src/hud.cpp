@@ -0,0 +1,107 @@
+#include "main.h"
+#include "hud.h"
+#include "uniforms.h"
+
+void Hud::create(int width, int height)
+{
+    glGenFramebuffers(1, &FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    float quad[] = {
+        -1.0f, 1.0f, 0.0f, 0.0f, 1.0f,
+        -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+        1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+
+        1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+        -1.0f, 1.0f, 0.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 0.0f, 1.0f, 1.0f};
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    dirty = true;
+}
+
+void Hud::set(int coins, int level, int target, int distance, bool endless)
+{
+    if (coins == this->coins && level == this->level && target == this->target &&
+        distance == this->distance && endless == this->endless)
+        return;
+    this->coins = coins;
+    this->level = level;
+    this->target = target;
+    this->distance = distance;
+    this->endless = endless;
+    dirty = true;
+}
+
+void Hud::draw(Text &text, Shader &textShader, Shader &hudShader)
+{
+    if (dirty)
+    {
+        char score[32];
+        char lev[32];
+        char goal[32];
+        char dist[48];
+        snprintf(score, sizeof(score), "Total Coins: %d", coins);
+        snprintf(dist, sizeof(dist), "Distance travelled: %d", distance);
+        if (endless)
+        {
+            snprintf(lev, sizeof(lev), "Endless");
+            goal[0] = '\0';
+        }
+        else
+        {
+            snprintf(lev, sizeof(lev), "Current Level: %d", level);
+            snprintf(goal, sizeof(goal), "Target: %d", target);
+        }
+
+        bool complete = text.add(score, 20.0f, 570.0f, 0.5f, glm::vec3(1.0f, 1.0f, 1.0f));
+        complete &= text.add(lev, 320.0f, 15.0f, 0.5f, glm::vec3(1.0f, 1.0f, 1.0f));
+        complete &= text.add(goal, 660.0f, 570.0f, 0.5f, glm::vec3(1.0f, 1.0f, 1.0f));
+        complete &= text.add(dist, 400.0f, 570.0f, 0.5f, glm::vec3(1.0f, 1.0f, 1.0f));
+
+        // keep the texture premultiplied so it composites with a plain
+        // (one, one - alpha) blend
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        text.draw(textShader);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        // placeholders are replaced as soon as their glyphs arrive
+        dirty = !complete;
+        redraws++;
+    }
+
+    hudShader.use();
+    hudShader.set(U_HUD, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindVertexArray(0);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+// premultiplied alpha, see Hud::draw
+uniform sampler2D hud;
+
+void main()
+{
+    FragColor = texture(hud, TexCoords);
+}
\ No newline at end of file
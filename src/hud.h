@@ -0,0 +1,35 @@
+#include "main.h"
+#include "shader.h"
+#include "text.h"
+
+#ifndef HUD_H
+#define HUD_H
+
+// The in-game HUD, kept laid out in its own texture. set() compares the
+// values shown against the last ones and only a change makes the next
+// draw() lay the strings out again; every other frame draw() just blends
+// the texture over the tone mapped frame with one quad.
+class Hud
+{
+public:
+    void create(int width, int height);
+    void set(int coins, int level, int target, int distance, bool endless);
+    void draw(Text &text, Shader &textShader, Shader &hudShader);
+
+    int redraws = 0; // times the text was laid out, for profiling
+
+private:
+    unsigned int FBO;
+    unsigned int texture;
+    unsigned int VAO;
+    unsigned int VBO;
+
+    int coins = 0;
+    int level = 0;
+    int target = 0;
+    int distance = 0;
+    bool endless = false;
+    bool dirty = true;
+};
+
+#endif
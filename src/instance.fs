@@ -0,0 +1,32 @@
+#version 330 core
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 BrightColor;
+
+in vec2 TexCoord;
+in vec4 Color;
+uniform bool circle; // TexCoord is the position on the unit circle
+uniform bool shine;
+uniform vec3 blur;
+
+void main()
+{
+    FragColor = Color;
+    if (circle)
+    {
+        // signed distance to the edge, faded over about one pixel
+        float d = length(TexCoord) - 1.0;
+        float edge = fwidth(d);
+        float coverage = clamp(0.5 - d / edge, 0.0, 1.0);
+        if (coverage == 0.0)
+            discard;
+        if (shine)
+        {
+            // darker rim and a highlight towards the top left
+            FragColor.rgb *= mix(1.0, 0.7, smoothstep(-0.15, -0.15 + edge, d));
+            float highlight = 1.0 - smoothstep(0.0, 0.35, length(TexCoord - vec2(-0.35, 0.35)));
+            FragColor.rgb = mix(FragColor.rgb, vec3(1.0), 0.6 * highlight);
+        }
+        FragColor.a *= coverage;
+    }
+    BrightColor = vec4(FragColor.rgb * blur, FragColor.a);
+}
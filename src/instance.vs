@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+// per instance
+layout (location = 2) in vec2 aOffset;
+layout (location = 3) in vec4 aColor;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+void main()
+{
+    gl_Position = vec4(aPos.xy + aOffset, aPos.z, 1.0);
+    TexCoord = aTexCoord;
+    Color = aColor;
+}
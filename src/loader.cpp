@@ -0,0 +1,139 @@
+#include "main.h"
+#include "loader.h"
+
+#include <fstream>
+#include <sstream>
+
+AssetLoader::~AssetLoader()
+{
+    // tasks may still be writing into what they were given
+    pool.wait();
+    if (PBO)
+        glDeleteBuffers(1, &PBO);
+}
+
+std::shared_future<std::string> AssetLoader::read(const std::string &path)
+{
+    return run<std::string>([path] {
+        std::ifstream file(path.c_str(), std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cout << "ERROR::LOADER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+            return std::string();
+        }
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    });
+}
+
+void AssetLoader::then(std::function<Step()> step)
+{
+    steps.push_back(step);
+    steps_total++;
+}
+
+void AssetLoader::shader(Shader &shader, const char *vertexPath, const char *fragmentPath)
+{
+    std::shared_future<std::string> vertex = read(vertexPath);
+    std::shared_future<std::string> fragment = read(fragmentPath);
+    Shader *target = &shader;
+    then([target, vertex, fragment]() -> Step {
+        if (!ready(vertex) || !ready(fragment))
+            return STEP_WAITING;
+        target->build(vertex.get().c_str(), fragment.get().c_str());
+        return STEP_DONE;
+    });
+}
+
+void AssetLoader::upload(unsigned int texture, std::shared_future<TextureArray> data)
+{
+    std::shared_ptr<Cursor> at(new Cursor());
+    then([this, texture, data, at]() -> Step {
+        if (!ready(data))
+            return STEP_WAITING;
+        return upload_chunk(texture, data.get(), *at);
+    });
+}
+
+// the next run of rows of one layer of one level, through the PBO
+AssetLoader::Step AssetLoader::upload_chunk(unsigned int texture, const TextureArray &data, Cursor &at)
+{
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    if (at.level == 0 && at.layer == 0 && at.row == 0)
+    {
+        // storage for every level first, filled in by this and later steps
+        for (size_t l = 0; l < data.levels.size(); l++)
+        {
+            int width = data.level_width(l), height = data.level_height(l);
+            if (data.compressed())
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, l, data.format, width, height, data.layers, 0, data.levels[l].size(), NULL);
+            else
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, l, data.format, width, height, data.layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        }
+    }
+
+    // compressed data goes by rows of 4x4 blocks
+    int width = data.level_width(at.level), height = data.level_height(at.level);
+    int block = data.compressed() ? 4 : 1;
+    size_t row_bytes = data.compressed() ? (size_t)(width + 3) / 4 * 16 : (size_t)width * 4;
+    int rows = (height + block - 1) / block;
+    int count = std::min((int)std::max((size_t)1, chunk_bytes / row_bytes), rows - at.row);
+    size_t bytes = row_bytes * count;
+    const unsigned char *source = &data.levels[at.level][row_bytes * (rows * at.layer + at.row)];
+
+    if (!PBO)
+        glGenBuffers(1, &PBO);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+    // a fresh store for every chunk, so the copy never waits on the last
+    // chunk's transfer out of it
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+    void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    memcpy(mapped, source, bytes);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    int y = at.row * block;
+    int h = std::min(count * block, height - y);
+    if (data.compressed())
+        glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, at.level, 0, y, at.layer, width, h, 1, data.format, bytes, (void *)0);
+    else
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, at.level, 0, y, at.layer, width, h, 1, GL_RGBA, GL_UNSIGNED_BYTE, (void *)0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    at.row += count;
+    if (at.row < rows)
+        return STEP_WORKED;
+    at.row = 0;
+    if (++at.layer < data.layers)
+        return STEP_WORKED;
+    at.layer = 0;
+    return ++at.level < (int)data.levels.size() ? STEP_WORKED : STEP_DONE;
+}
+
+bool AssetLoader::update(double budget)
+{
+    steady_clock::time_point start = steady_clock::now();
+    // round after round over the steps, in the order they were queued,
+    // until the budget is spent or all of them are waiting
+    bool worked = true;
+    while (!steps.empty() && worked)
+    {
+        worked = false;
+        for (std::list<std::function<Step()>>::iterator step = steps.begin(); step != steps.end();)
+        {
+            if (duration<double>(steady_clock::now() - start).count() >= budget)
+                return false;
+            Step result = (*step)();
+            worked = worked || result != STEP_WAITING;
+            if (result == STEP_DONE)
+            {
+                step = steps.erase(step);
+                steps_done++;
+            }
+            else
+                step++;
+        }
+    }
+    return steps.empty();
+}
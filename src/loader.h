@@ -0,0 +1,82 @@
+#include "main.h"
+#include "shader.h"
+#include "assets/texture.h"
+#include "sim/thread_pool.h"
+
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+
+// Loads assets while the window already shows a loading screen. File
+// reads, decoding and FreeType run as tasks on a thread pool and hand back
+// futures; whatever then needs the GL (compiling shaders, uploading pixels)
+// is queued as steps that update() runs on the GL thread, a slice at a time,
+// for as long as the frame's budget allows. Texture data goes up through a
+// pixel buffer object in chunks, so no single step stalls a frame for long
+// whatever the size of the asset.
+class AssetLoader
+{
+public:
+    enum Step
+    {
+        STEP_WAITING, // for a future, nothing done
+        STEP_WORKED,  // did a slice, call again
+        STEP_DONE
+    };
+
+    static const size_t chunk_bytes = 256 * 1024; // most pixels one upload step copies
+
+    AssetLoader() : pool(0) {}
+    ~AssetLoader();
+
+    // runs on a worker
+    template <class T>
+    std::shared_future<T> run(std::function<T()> work)
+    {
+        std::shared_ptr<std::packaged_task<T()>> task(new std::packaged_task<T()>(work));
+        std::shared_future<T> result = task->get_future().share();
+        pool.submit([task] { (*task)(); });
+        return result;
+    }
+    std::shared_future<std::string> read(const std::string &path);
+
+    // on the GL thread, from update(); called until it returns STEP_DONE
+    void then(std::function<Step()> step);
+    // compiles the shader once both files are read
+    void shader(Shader &shader, const char *vertexPath, const char *fragmentPath);
+    // fills every level of a texture array allocated to the same layout
+    void upload(unsigned int texture, std::shared_future<TextureArray> data);
+
+    // runs steps for up to budget seconds; true once every step is done
+    bool update(double budget);
+    float progress() const { return steps_total ? (float)steps_done / steps_total : 1.0f; }
+
+    template <class T>
+    static bool ready(const std::shared_future<T> &future)
+    {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+private:
+    // how far an upload has got
+    struct Cursor
+    {
+        int level = 0;
+        int layer = 0;
+        int row = 0;
+    };
+
+    Step upload_chunk(unsigned int texture, const TextureArray &data, Cursor &at);
+
+    ThreadPool pool;
+    std::list<std::function<Step()>> steps;
+    int steps_total = 0;
+    int steps_done = 0;
+    unsigned int PBO = 0;
+};
+
+#endif
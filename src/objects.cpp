@@ -1,147 +1,52 @@
 #include "main.h"
 #include "objects.h"
-const float pi = 3.14159265;
-int i = 1;
+#include "uniforms.h"
 
-void Coin::createVAO(int setLevel)
-{
-    unsigned int VBO, EBO;
-    float coin[9 * num];
-    level = setLevel;
-    size = 0.032;
-
-    for (int i = 0; i < num; i++)
-    {
-        coin[9 * i + 0] = (0.032 * cos(i * 2 * pi / num));
-        coin[9 * i + 1] = (0.032 * sin(i * 2 * pi / num));
-        coin[9 * i + 2] = 0.0;
-
-        coin[9 * i + 3] = (0.032 * cos((i + 1) * 2 * pi / num));
-        coin[9 * i + 4] = (0.032 * sin((i + 1) * 2 * pi / num));
-        coin[9 * i + 5] = 0.0;
-
-        coin[9 * i + 6] = 0.0;
-        coin[9 * i + 7] = 0.0;
-        coin[9 * i + 8] = 0.0;
-    }
-
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(coin), coin, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
-    glEnableVertexAttribArray(0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-}
-
-void Coin::draw(unsigned int shaderProgram, int visible)
-{
-    x -= 0.01;
-
-    random_device rd;
-    mt19937 gen(rd() * level);
-    uniform_real_distribution<> distr(-0.6, 0.6);
-
-    if (!visible)
-    {
-        x = 1.1;
-        y = distr(gen);
-    }
-
-    if (x < -1.1)
-    {
-        x = 1.1;
-        y = distr(gen);
-    }
-
-    glUseProgram(shaderProgram);
-    trans = glm::translate(trans, glm::vec3(x, y, 0));
-
-    unsigned int transformLoc = glGetUniformLocation(shaderProgram, "transform");
-    glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(trans));
-
-    trans = glm::mat4(1.0f);
-
-    int vertexColorLocation = glGetUniformLocation(shaderProgram, "col");
-    glUniform4f(vertexColorLocation, 1.0f, 0.843f, 0.0f, 1.0f);
-
-    glBindVertexArray(VAO); // seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized
-    glDrawArrays(GL_TRIANGLES, 0, 3 * num);
-    glBindVertexArray(0);
-}
+// glVertexAttribDivisor is GL 3.3 core, one version past what the bundled
+// glad loader covers, so it is fetched from the context by hand
+typedef void (*VertexAttribDivisor)(GLuint index, GLuint divisor);
+static VertexAttribDivisor glVertexAttribDivisor = NULL;
 
-bool Game::coin_collision(Bobby player, Coin coin)
+// instance attributes 2-3 (see instance.vs), advancing once per instance,
+// pointed at instances written to the stream at offset; the VAO is bound
+static void point_instances(unsigned int buffer, size_t offset)
 {
-    bool collisionX = player.abs_x + player.size_x >= coin.x - coin.size && coin.x + coin.size >= player.abs_x - player.size_x;
-    bool collisionY = player.abs_y + player.size_y >= coin.y - coin.size && coin.y + coin.size >= player.abs_y - player.size_y;
-    return collisionX && collisionY;
-}
-
-bool Game::zapper_collision(Bobby player, Zapper zapper)
-{
-    float x1 = zapper.abs_x - (zapper.size_y * sin(zapper.rotation));
-    float y1 = zapper.abs_y - (zapper.size_y * cos(zapper.rotation));
-    float x2 = zapper.abs_x + (zapper.size_y * sin(zapper.rotation));
-    float y2 = zapper.abs_y + (zapper.size_y * cos(zapper.rotation));
-
-    float player_top = player.abs_y + player.size_y;
-    float player_bottom = player.abs_y - player.size_y;
-    float player_right = player.abs_x + player.size_x;
-    float player_left = player.abs_x - player.size_x;
-
-    bool left_collision = check_collision(x1, y1, x2, y2, player_left, player_top, player_left, player_bottom);
-    bool right_collision = check_collision(x1, y1, x2, y2, player_right, player_top, player_right, player_bottom);
-    bool top_collision = check_collision(x1, y1, x2, y2, player_left, player_top, player_right, player_top);
-    bool bottom_collision = check_collision(x1, y1, x2, y2, player_left, player_bottom, player_right, player_bottom);
-
-    if (left_collision || right_collision || top_collision || bottom_collision)
-    {
-        return true;
-    }
-    else
-    {
-        return false;
-    }
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *)offset);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void *)(offset + offsetof(Instance, r)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-bool check_collision(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4)
+static void setup_instances(unsigned int buffer)
 {
-    float A = ((x4 - x3) * (y1 - y3) - (y4 - y3) * (x1 - x3)) / ((y4 - y3) * (x2 - x1) - (x4 - x3) * (y2 - y1));
-    float B = ((x2 - x1) * (y1 - y3) - (y2 - y1) * (x1 - x3)) / ((y4 - y3) * (x2 - x1) - (x4 - x3) * (y2 - y1));
+    if (!glVertexAttribDivisor)
+        glVertexAttribDivisor = (VertexAttribDivisor)glfwGetProcAddress("glVertexAttribDivisor");
 
-    if (A >= 0 && A <= 1 && B >= 0 && B <= 1)
+    point_instances(buffer, 0);
+    for (int i = 2; i <= 3; i++)
     {
-        return true;
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
     }
-
-    return false;
 }
 
-void Zapper::createVAO(int setLevel)
+void Coin::createVAO(StreamBuffer &stream)
 {
-    unsigned int VBO, EBO;
-    level = setLevel;
-    size_y = 0.15;
-    size_x = 0.03;
-
-    float zapper[] = {
-        0.8f, -0.3f, 0.0f, 1.0f, 1.0f,
-        0.8f, -0.6f, 0.0f, 1.0f, 0.0f,
-        0.74f, -0.6f, 0.0f, 0.0f, 0.0f,
-        0.74f, -0.3f, 0.0f, 0.0f, 1.0f};
-
-    unsigned int zapper_indices[] = {
+    this->stream = &stream;
+    unsigned int EBO;
+
+    // one quad for every coin; the fragment shader cuts the circle out of it
+    // using texture coordinates that run from -1 to 1 across the quad
+    float coin[] = {
+        radius, radius, 0.0f, 1.0f, 1.0f,
+        radius, -radius, 0.0f, 1.0f, -1.0f,
+        -radius, -radius, 0.0f, -1.0f, -1.0f,
+        -radius, radius, 0.0f, -1.0f, 1.0f};
+
+    unsigned int coin_indices[] = {
         0, 1, 2,
         0, 2, 3};
 
-    abs_x = 0.77f;
-    abs_y = -0.45f;
-
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
@@ -149,55 +54,82 @@ void Zapper::createVAO(int setLevel)
     glBindVertexArray(VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(zapper), zapper, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(coin), coin, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(zapper_indices), zapper_indices, GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(coin_indices), coin_indices, GL_STATIC_DRAW);
 
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
     glEnableVertexAttribArray(0);
-    // texture coord attribute
+    // position on the unit circle
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
+    setup_instances(stream.ID);
+
     glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
 }
 
-void Zapper::draw(unsigned int shaderProgram)
+void Coin::prepare(Shader &shader)
 {
-    x -= 0.01;
-
-    rotation += level * pi / 120;
-
-    random_device rd;
-    mt19937 gen(rd() * level);
-    uniform_real_distribution<> distr(-0.1, 0.95);
-
-    glUseProgram(shaderProgram);
+    shader.use();
+    shader.set(U_CIRCLE, true);
+    shader.set(U_SHINE, true);
+    shader.set(U_BLUR, glm::vec3(0.0f));
+}
 
-    if (x < -1.8)
+void Coin::submit(RenderQueue &queue, Shader &shader, const std::vector<DrawItem> &items)
+{
+    instances.clear();
+    for (size_t i = 0; i < items.size(); i++)
     {
-        x = 0.5;
-        y = distr(gen);
+        if (items[i].mesh != MESH_COIN)
+            continue;
+        Instance coin = {items[i].x, items[i].y, 1.0f, 0.843f, 0.0f, 1.0f};
+        instances.push_back(coin);
     }
+    if (instances.empty())
+        return;
 
-    abs_x = 0.77f + x;
-    abs_y = -0.45f + y;
-
-    trans = glm::translate(trans, glm::vec3(abs_x, abs_y, 0));
-    trans = glm::rotate(trans, rotation, glm::vec3(0.0f, 0.0f, 1.0f));
-    trans = glm::translate(trans, glm::vec3(-abs_x, -abs_y, 0));
-    trans = glm::translate(trans, glm::vec3(x, y, 0));
-
-    unsigned int transformLoc = glGetUniformLocation(shaderProgram, "transform");
-    glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(trans));
+    size_t offset = stream->write(instances.data(), instances.size() * sizeof(Instance));
+    glBindVertexArray(VAO);
+    point_instances(stream->ID, offset);
+    glBindVertexArray(0);
+    queue.submit(PASS_SCENE, LAYER_COINS, shader, GL_TEXTURE_2D, 0, VAO, GL_TRIANGLES, true, 0, 6, instances.size());
+}
 
-    trans = glm::mat4(1.0f);
+// the corners of one zapper, counter-clockwise from the bottom left of its
+// image, rotated about its pivot
+static void place(const DrawItem &item, glm::vec2 corners[4])
+{
+    const float quad[4][2] = {{0.74f, -0.6f}, {0.8f, -0.6f}, {0.8f, -0.3f}, {0.74f, -0.3f}};
+    float s = sin(item.rotation);
+    float c = cos(item.rotation);
+    for (int i = 0; i < 4; i++)
+    {
+        float x = quad[i][0] + item.x - item.pivot_x;
+        float y = quad[i][1] + item.y - item.pivot_y;
+        corners[i] = glm::vec2(item.pivot_x + c * x - s * y, item.pivot_y + s * x + c * y);
+    }
+}
 
-    int vertexColorLocation = glGetUniformLocation(shaderProgram, "col");
-    glUniform4f(vertexColorLocation, 1.0f, 0.0f, 0.0f, 1.0f);
+void Zapper::add(SpriteBatch &sprites, const std::vector<DrawItem> &items)
+{
+    glm::vec2 corners[4];
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        if (items[i].mesh != MESH_ZAPPER)
+            continue;
+        place(items[i], corners);
+        sprites.add(SPRITE_ZAPPER, LAYER_ZAPPERS, corners, true);
+    }
+}
 
-    glBindVertexArray(VAO); // seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-}
\ No newline at end of file
+void Zapper::bounds(const DrawItem &item, glm::vec2 &lo, glm::vec2 &hi) const
+{
+    glm::vec2 corners[4];
+    place(item, corners);
+    lo = glm::min(glm::min(corners[0], corners[1]), glm::min(corners[2], corners[3]));
+    hi = glm::max(glm::max(corners[0], corners[1]), glm::max(corners[2], corners[3]));
+}
@@ -4,49 +4,45 @@
 #ifndef OBJECTS_H
 #define OBJECTS_H
 
-class Coin
+// What instance.vs reads per coin: where it is and its colour.
+struct Instance
 {
-public:
-    unsigned int VAO;
-    unsigned int VBO;
-    void createVAO(int setLevel);
-    glm::mat4 trans;
-    Coin() { trans = glm::mat4(1.0f); }
-    void draw(unsigned int shaderProgram, int visible);
-    int num = 100;
-    float x = 0;
-    float y = 0;
-    float size;
-    int visible = 1;
-    int level;
+    float x;
+    float y;
+    float r;
+    float g;
+    float b;
+    float a;
 };
 
-class Zapper
+// Coins have one mesh and stream their instances; submit() writes one
+// instance for every coin and queues them all as a single instanced draw,
+// however many there are. Zappers are sprites and go into the frame's
+// SpriteBatch.
+
+class Coin
 {
 public:
     unsigned int VAO;
-    void createVAO(int setLevel);
-    glm::mat4 trans;
-    Zapper() { trans = glm::mat4(1.0f); }
-    void draw(unsigned int shaderProgram);
-    float x = 0;
-    float y = 0;
-    float abs_x;
-    float abs_y;
-    float size_x;
-    float size_y;
-    float rotation = 0;
-    int level;
+    unsigned int VBO;
+    // the instances are streamed through `stream` every frame
+    void createVAO(StreamBuffer &stream);
+    // sets the uniforms coins are drawn with, which never change
+    void prepare(Shader &shader);
+    void submit(RenderQueue &queue, Shader &shader, const std::vector<DrawItem> &items);
+    float radius = 0.032f;
+    std::vector<Instance> instances;
+
+private:
+    StreamBuffer *stream;
 };
 
-class Game
+class Zapper
 {
 public:
-    bool coin_collision(Bobby player, Coin coin);
-    bool zapper_collision(Bobby player, Zapper zapper);
-    void game_over(GLFWwindow *window);
+    void add(SpriteBatch &sprites, const std::vector<DrawItem> &items);
+    // box around one rotated zapper, in normalized device coordinates
+    void bounds(const DrawItem &item, glm::vec2 &lo, glm::vec2 &hi) const;
 };
 
-bool check_collision(float x1, float y1, float x2, float y2, float x3, float y3, float x4, float y4);
-
 #endif
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "main.h"
+#include "render_queue.h"
+
+// field positions in the sort key; GL names are cut to 16 bits, which at
+// worst sorts two objects as one and costs a bind, never a wrong draw
+static const int PASS_SHIFT = 60;
+static const int LAYER_SHIFT = 52;
+static const int PROGRAM_SHIFT = 36;
+static const int TEXTURE_SHIFT = 20;
+static const int VAO_SHIFT = 4;
+
+void RenderQueue::clear()
+{
+    packets.clear();
+    order.clear();
+    stats = RenderStats();
+}
+
+void RenderQueue::submit(RenderPass pass, int layer, Shader &shader, GLenum target, unsigned int texture,
+                         unsigned int VAO, GLenum mode, bool indexed, int first, int count, int instances)
+{
+    if (count == 0)
+        return;
+    DrawPacket packet;
+    packet.key = (uint64_t)pass << PASS_SHIFT |
+                 (uint64_t)(layer & 0xff) << LAYER_SHIFT |
+                 (uint64_t)(shader.ID & 0xffff) << PROGRAM_SHIFT |
+                 (uint64_t)(texture & 0xffff) << TEXTURE_SHIFT |
+                 (uint64_t)(VAO & 0xffff) << VAO_SHIFT;
+    packet.shader = &shader;
+    packet.target = target;
+    packet.texture = texture;
+    packet.VAO = VAO;
+    packet.mode = mode;
+    packet.indexed = indexed;
+    packet.first = first;
+    packet.count = count;
+    packet.instances = instances;
+    packets.push_back(packet);
+}
+
+void RenderQueue::sort()
+{
+    size_t n = packets.size();
+    order.resize(n);
+    scratch.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        order[i].key = packets[i].key;
+        order[i].index = i;
+    }
+    if (n < 2)
+        return;
+
+    // least significant byte first; every pass is stable, so packets with
+    // equal keys stay in the order they were submitted
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        size_t offsets[256] = {0};
+        for (size_t i = 0; i < n; i++)
+            offsets[(order[i].key >> shift) & 0xff]++;
+        // most bytes are the same in every key, those passes move nothing
+        if (offsets[(order[0].key >> shift) & 0xff] == n)
+            continue;
+        size_t sum = 0;
+        for (int b = 0; b < 256; b++)
+        {
+            size_t count = offsets[b];
+            offsets[b] = sum;
+            sum += count;
+        }
+        for (size_t i = 0; i < n; i++)
+            scratch[offsets[(order[i].key >> shift) & 0xff]++] = order[i];
+        order.swap(scratch);
+    }
+}
+
+// plain draws of the same state whose vertices follow on from each other
+static bool joins(const DrawPacket &a, const DrawPacket &b)
+{
+    return !a.indexed && !b.indexed && a.instances == 0 && b.instances == 0 &&
+           a.shader == b.shader && a.texture == b.texture && a.VAO == b.VAO &&
+           a.mode == b.mode && a.first + a.count == b.first;
+}
+
+void RenderQueue::execute(RenderPass pass)
+{
+    // the packets of a pass are one run of the sorted order
+    size_t i = 0;
+    while (i < order.size() && (int)(order[i].key >> PASS_SHIFT) < pass)
+        i++;
+
+    unsigned int program = 0, texture = 0, VAO = 0;
+    glActiveTexture(GL_TEXTURE0);
+    while (i < order.size() && (int)(order[i].key >> PASS_SHIFT) == pass)
+    {
+        DrawPacket draw = packets[order[i].index];
+        stats.packets++;
+        for (i++; i < order.size() && joins(draw, packets[order[i].index]); i++)
+        {
+            draw.count += packets[order[i].index].count;
+            stats.packets++;
+        }
+
+        if (draw.shader->ID != program)
+        {
+            draw.shader->use();
+            program = draw.shader->ID;
+            stats.programs++;
+        }
+        if (draw.texture != 0 && draw.texture != texture)
+        {
+            glBindTexture(draw.target, draw.texture);
+            texture = draw.texture;
+            stats.textures++;
+        }
+        if (draw.VAO != VAO)
+        {
+            glBindVertexArray(draw.VAO);
+            VAO = draw.VAO;
+            stats.vertex_arrays++;
+        }
+
+        if (draw.indexed && draw.instances > 0)
+            glDrawElementsInstanced(draw.mode, draw.count, GL_UNSIGNED_INT, (void *)(draw.first * sizeof(unsigned int)), draw.instances);
+        else if (draw.indexed)
+            glDrawElements(draw.mode, draw.count, GL_UNSIGNED_INT, (void *)(draw.first * sizeof(unsigned int)));
+        else if (draw.instances > 0)
+            glDrawArraysInstanced(draw.mode, draw.first, draw.count, draw.instances);
+        else
+            glDrawArrays(draw.mode, draw.first, draw.count);
+        stats.draws++;
+    }
+    glBindVertexArray(0);
+}
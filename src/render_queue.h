@@ -0,0 +1,85 @@
+#include "main.h"
+#include "shader.h"
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+
+// The passes packets are drawn in, in frame order.
+enum RenderPass
+{
+    PASS_SCENE,  // into the scene target
+    PASS_BRIGHT, // again into the half resolution bright target, under LEAN
+    NUM_PASSES
+};
+
+// Back to front within a pass. Packets on one layer may be drawn in any
+// order the sort likes, so only things that blend over each other need
+// different layers.
+enum RenderLayer
+{
+    LAYER_BACKGROUND,
+    LAYER_PLAYER,
+    LAYER_COINS,
+    LAYER_ZAPPERS
+};
+
+// One draw and everything it needs bound. texture goes on unit 0, 0 when
+// the shader samples nothing.
+struct DrawPacket
+{
+    uint64_t key;
+    Shader *shader;
+    GLenum target;
+    unsigned int texture;
+    unsigned int VAO;
+    GLenum mode;
+    bool indexed; // count unsigned int indices from the VAO's element buffer
+    int first;
+    int count;
+    int instances; // 0 for a plain draw
+};
+
+// What execute() sent to GL, summed over every pass since clear().
+struct RenderStats
+{
+    int packets;
+    int draws;
+    int programs;
+    int textures;
+    int vertex_arrays;
+};
+
+// Draws are submitted as packets during the frame instead of being issued
+// as they come. sort() orders them by a 64 bit key (pass, layer, program,
+// texture, vertex array from the top bits down) with a radix sort, and
+// execute() then replays one pass, binding only what differs from the
+// packet before and joining packets that draw consecutive vertices with
+// the same state into one call. Uniforms are not part of a packet; the
+// Shader setters already skip unchanged values.
+class RenderQueue
+{
+public:
+    RenderStats stats;
+
+    void clear();
+    void submit(RenderPass pass, int layer, Shader &shader, GLenum target, unsigned int texture,
+                unsigned int VAO, GLenum mode, bool indexed, int first, int count, int instances = 0);
+    void sort();
+    // leaves no vertex array bound
+    void execute(RenderPass pass);
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<DrawPacket> packets;
+    std::vector<Entry> order; // packets by key once sorted
+    std::vector<Entry> scratch;
+};
+
+#endif
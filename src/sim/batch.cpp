@@ -0,0 +1,75 @@
+#include <random>
+
+#include "batch.h"
+#include "world.h"
+
+unsigned long long run_seed(unsigned long long seed, int run)
+{
+    // splitmix64, so neighbouring runs get unrelated streams
+    unsigned long long z = seed + (unsigned long long)(run + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+bool parse_policy(const std::string &name, Policy &policy)
+{
+    if (name == "random")
+        policy = POLICY_RANDOM;
+    else if (name == "hover")
+        policy = POLICY_HOVER;
+    else
+        return false;
+    return true;
+}
+
+const char *policy_name(Policy policy)
+{
+    return policy == POLICY_HOVER ? "hover" : "random";
+}
+
+RunResult play_run(const RunConfig &config)
+{
+    World world(config.seed);
+    if (config.levels)
+        world.levels = *config.levels;
+    if (config.endless)
+        world.start_endless(false);
+    else
+        world.start_level(config.level);
+
+    std::mt19937 policy_gen((unsigned int)(config.seed >> 32) ^ 0x5bd1e995u);
+    std::uniform_int_distribution<int> hold_ticks((int)(config.tick_rate * 0.05), (int)(config.tick_rate * 0.4));
+    std::bernoulli_distribution press(0.5);
+
+    int length = config.max_distance > 0 ? config.max_distance : config.endless ? endless_length : world.params.length;
+    double dt = 1.0 / config.tick_rate;
+
+    Input input;
+    int hold = 0;
+    long ticks = 0;
+    while (!world.dead && world.distance() < length)
+    {
+        if (config.policy == POLICY_HOVER)
+        {
+            input.fly = world.player.y < 0.4;
+        }
+        else if (hold-- <= 0)
+        {
+            input.fly = press(policy_gen);
+            hold = hold_ticks(policy_gen);
+        }
+
+        world.step(input, dt);
+        ticks++;
+    }
+
+    RunResult result;
+    result.seed = config.seed;
+    result.level = config.endless ? 0 : world.level; // start_level clamps it
+    result.distance = world.time;
+    result.coins = world.coins_collected;
+    result.ticks = ticks;
+    result.cause = world.dead ? "zapper" : "cleared";
+    return result;
+}
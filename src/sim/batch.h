@@ -0,0 +1,50 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string>
+#include <vector>
+
+#include "levels.h"
+
+// Headless runs of a single level with a scripted input policy, used to
+// tune difficulty from thousands of games instead of playtesting.
+
+enum Policy
+{
+    POLICY_RANDOM, // holds or releases fly for random short stretches
+    POLICY_HOVER   // keeps the player around mid height
+};
+
+struct RunConfig
+{
+    unsigned long long seed = 0;
+    int level = 1;
+    Policy policy = POLICY_RANDOM;
+    double tick_rate = 60;
+    int max_distance = 0; // 0 = the level's own length
+    bool endless = false; // endless track instead of `level`
+    const std::vector<LevelDesc> *levels = NULL; // NULL = the built in levels
+};
+
+struct RunResult
+{
+    unsigned long long seed;
+    int level; // 0 for endless runs
+    double distance; // simulated seconds survived
+    int coins;
+    long ticks;
+    const char *cause; // "zapper" or "cleared"
+};
+
+RunResult play_run(const RunConfig &config);
+
+// endless runs stop here unless max_distance says otherwise
+const int endless_length = 120;
+
+// independent seed for run number `run` of a batch seeded with `seed`
+unsigned long long run_seed(unsigned long long seed, int run);
+
+bool parse_policy(const std::string &name, Policy &policy);
+const char *policy_name(Policy policy);
+
+#endif
@@ -0,0 +1,93 @@
+#include <algorithm>
+
+#include "broadphase.h"
+
+static bool by_min_x(const SweepAndPrune::Interval &a, const SweepAndPrune::Interval &b)
+{
+    return a.min_x < b.min_x;
+}
+
+void SweepAndPrune::resize(size_t n)
+{
+    if (n < intervals.size())
+    {
+        // drop the removed ids wherever they sit in the order
+        size_t kept = 0;
+        for (size_t i = 0; i < intervals.size(); i++)
+        {
+            if ((size_t)intervals[i].id < n)
+                intervals[kept++] = intervals[i];
+        }
+        intervals.resize(n);
+    }
+    else
+    {
+        for (size_t id = intervals.size(); id < n; id++)
+        {
+            Interval empty = {1e30f, 1e30f, (int)id};
+            intervals.push_back(empty);
+        }
+    }
+
+    slot.resize(n);
+    for (size_t i = 0; i < intervals.size(); i++)
+        slot[intervals[i].id] = i;
+}
+
+void SweepAndPrune::set(int id, float min_x, float max_x)
+{
+    Interval &interval = intervals[slot[id]];
+    interval.min_x = min_x;
+    interval.max_x = max_x;
+}
+
+void SweepAndPrune::sort()
+{
+    // Scrolling keeps the relative order, so only respawns that jumped to
+    // the right edge are out of place. Pull those out (scanning from the
+    // right, anything larger than what follows it), sort the few of them and
+    // merge them back in, instead of shifting each one across the whole list.
+    moved.clear();
+    float lowest = 1e30f;
+    size_t kept = intervals.size();
+    for (size_t i = intervals.size(); i-- > 0;)
+    {
+        if (intervals[i].min_x <= lowest)
+        {
+            lowest = intervals[i].min_x;
+            intervals[--kept] = intervals[i];
+        }
+        else
+        {
+            moved.push_back(intervals[i]);
+        }
+    }
+
+    if (!moved.empty())
+    {
+        std::sort(moved.begin(), moved.end(), by_min_x);
+        merged.resize(intervals.size());
+        std::merge(intervals.begin() + kept, intervals.end(), moved.begin(), moved.end(), merged.begin(), by_min_x);
+        intervals.swap(merged);
+    }
+
+    widest = 0;
+    for (size_t i = 0; i < intervals.size(); i++)
+    {
+        slot[intervals[i].id] = i;
+        widest = std::max(widest, intervals[i].max_x - intervals[i].min_x);
+    }
+}
+
+void SweepAndPrune::query(float min_x, float max_x, std::vector<int> &out) const
+{
+    // nothing that starts before min_x - widest can still reach min_x
+    Interval from = {min_x - widest, 0, 0};
+    std::vector<Interval>::const_iterator it = std::lower_bound(intervals.begin(), intervals.end(), from, by_min_x);
+
+    for (; it != intervals.end() && it->min_x <= max_x; ++it)
+    {
+        if (it->max_x >= min_x)
+            out.push_back(it->id);
+    }
+}
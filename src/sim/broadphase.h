@@ -0,0 +1,39 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include <cstddef>
+#include <vector>
+
+// Sweep and prune along the scroll axis. Obstacles are kept as x-intervals
+// sorted by their left edge; everything scrolls left at the same speed, so
+// the order hardly changes between ticks and is restored incrementally in
+// close to linear time. Queries only visit intervals near the player.
+class SweepAndPrune
+{
+public:
+    // ids are 0..n-1, new ids start with an empty interval far to the right
+    void resize(size_t n);
+    size_t size() const { return intervals.size(); }
+
+    void set(int id, float min_x, float max_x);
+    void sort();
+
+    // appends the ids whose interval overlaps [min_x, max_x]
+    void query(float min_x, float max_x, std::vector<int> &out) const;
+
+    struct Interval
+    {
+        float min_x;
+        float max_x;
+        int id;
+    };
+
+private:
+    std::vector<Interval> intervals; // sorted by min_x after sort()
+    std::vector<int> slot;           // id -> position in intervals
+    std::vector<Interval> moved;
+    std::vector<Interval> merged;
+    float widest = 0;
+};
+
+#endif
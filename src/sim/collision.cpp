@@ -0,0 +1,227 @@
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_AVX2_KERNEL
+#endif
+
+#include "collision.h"
+#include "world.h"
+
+void ZapperColliders::resize(size_t n)
+{
+    x.resize(n);
+    y.resize(n);
+    axis_x.resize(n);
+    axis_y.resize(n);
+    half_length.resize(n);
+    half_width.resize(n);
+}
+
+void ZapperColliders::set(size_t i, float centre_x, float centre_y, float rotation, float length, float width)
+{
+    // the sprite's long side is vertical before being rotated by `rotation`
+    x[i] = centre_x;
+    y[i] = centre_y;
+    axis_x[i] = -sinf(rotation);
+    axis_y[i] = cosf(rotation);
+    half_length[i] = length;
+    half_width[i] = width;
+}
+
+float ZapperColliders::reach_x(size_t i) const
+{
+    return half_length[i] * fabsf(axis_x[i]) + half_width[i] * fabsf(axis_y[i]);
+}
+
+void ZapperColliders::gather(const ZapperColliders &from, const std::vector<int> &ids)
+{
+    resize(ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        int j = ids[i];
+        x[i] = from.x[j];
+        y[i] = from.y[j];
+        axis_x[i] = from.axis_x[j];
+        axis_y[i] = from.axis_y[j];
+        half_length[i] = from.half_length[j];
+        half_width[i] = from.half_width[j];
+    }
+}
+
+Box player_box(const PlayerState &player)
+{
+    Box box = {player.abs_x, player.abs_y, player.size_x, player.size_y};
+    return box;
+}
+
+bool box_overlap(const Box &a, const Box &b)
+{
+    bool collisionX = a.x + a.half_x >= b.x - b.half_x && b.x + b.half_x >= a.x - a.half_x;
+    bool collisionY = a.y + a.half_y >= b.y - b.half_y && b.y + b.half_y >= a.y - a.half_y;
+    return collisionX && collisionY;
+}
+
+// Separating axis test against the box's x and y axes and the zapper's own
+// two axes; the shapes overlap when no axis separates them.
+// The SIMD kernels below do the same operations in the same order, with
+// no fused multiply-adds, so a grazing contact comes out the same on every
+// CPU and a seeded run plays out the same wherever it runs.
+static bool overlap_one(const Box &box, const ZapperColliders &c, size_t i)
+{
+    float dx = c.x[i] - box.x;
+    float dy = c.y[i] - box.y;
+    float ax = fabsf(c.axis_x[i]);
+    float ay = fabsf(c.axis_y[i]);
+    float hl = c.half_length[i];
+    float hw = c.half_width[i];
+
+    return fabsf(dx) <= box.half_x + (hl * ax + hw * ay) &&
+           fabsf(dy) <= box.half_y + (hl * ay + hw * ax) &&
+           fabsf(dx * c.axis_x[i] + dy * c.axis_y[i]) <= hl + (box.half_x * ax + box.half_y * ay) &&
+           fabsf(dx * c.axis_y[i] - dy * c.axis_x[i]) <= hw + (box.half_x * ay + box.half_y * ax);
+}
+
+static int overlap_scalar(const Box &box, const ZapperColliders &c, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        if (overlap_one(box, c, i))
+            return i;
+    }
+    return -1;
+}
+
+#if defined(__SSE2__)
+static int overlap_sse2(const Box &box, const ZapperColliders &c, size_t begin, size_t end)
+{
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 bx = _mm_set1_ps(box.x);
+    const __m128 by = _mm_set1_ps(box.y);
+    const __m128 ex = _mm_set1_ps(box.half_x);
+    const __m128 ey = _mm_set1_ps(box.half_y);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 ux = _mm_loadu_ps(&c.axis_x[i]);
+        __m128 uy = _mm_loadu_ps(&c.axis_y[i]);
+        __m128 hl = _mm_loadu_ps(&c.half_length[i]);
+        __m128 hw = _mm_loadu_ps(&c.half_width[i]);
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(&c.x[i]), bx);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(&c.y[i]), by);
+        __m128 ax = _mm_andnot_ps(sign, ux);
+        __m128 ay = _mm_andnot_ps(sign, uy);
+
+        __m128 on_x = _mm_cmple_ps(_mm_andnot_ps(sign, dx),
+                                   _mm_add_ps(ex, _mm_add_ps(_mm_mul_ps(hl, ax), _mm_mul_ps(hw, ay))));
+        __m128 on_y = _mm_cmple_ps(_mm_andnot_ps(sign, dy),
+                                   _mm_add_ps(ey, _mm_add_ps(_mm_mul_ps(hl, ay), _mm_mul_ps(hw, ax))));
+        __m128 along = _mm_add_ps(_mm_mul_ps(dx, ux), _mm_mul_ps(dy, uy));
+        __m128 on_long = _mm_cmple_ps(_mm_andnot_ps(sign, along),
+                                      _mm_add_ps(hl, _mm_add_ps(_mm_mul_ps(ex, ax), _mm_mul_ps(ey, ay))));
+        __m128 across = _mm_sub_ps(_mm_mul_ps(dx, uy), _mm_mul_ps(dy, ux));
+        __m128 on_short = _mm_cmple_ps(_mm_andnot_ps(sign, across),
+                                       _mm_add_ps(hw, _mm_add_ps(_mm_mul_ps(ex, ay), _mm_mul_ps(ey, ax))));
+
+        int hits = _mm_movemask_ps(_mm_and_ps(_mm_and_ps(on_x, on_y), _mm_and_ps(on_long, on_short)));
+        if (hits)
+            return i + __builtin_ctz(hits);
+    }
+    return overlap_scalar(box, c, i, end);
+}
+#endif
+
+#if defined(HAVE_AVX2_KERNEL)
+__attribute__((target("avx2"))) static int overlap_avx2(const Box &box, const ZapperColliders &c, size_t begin, size_t end)
+{
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 bx = _mm256_set1_ps(box.x);
+    const __m256 by = _mm256_set1_ps(box.y);
+    const __m256 ex = _mm256_set1_ps(box.half_x);
+    const __m256 ey = _mm256_set1_ps(box.half_y);
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 ux = _mm256_loadu_ps(&c.axis_x[i]);
+        __m256 uy = _mm256_loadu_ps(&c.axis_y[i]);
+        __m256 hl = _mm256_loadu_ps(&c.half_length[i]);
+        __m256 hw = _mm256_loadu_ps(&c.half_width[i]);
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(&c.x[i]), bx);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(&c.y[i]), by);
+        __m256 ax = _mm256_andnot_ps(sign, ux);
+        __m256 ay = _mm256_andnot_ps(sign, uy);
+
+        __m256 on_x = _mm256_cmp_ps(_mm256_andnot_ps(sign, dx),
+                                    _mm256_add_ps(ex, _mm256_add_ps(_mm256_mul_ps(hl, ax), _mm256_mul_ps(hw, ay))), _CMP_LE_OQ);
+        __m256 on_y = _mm256_cmp_ps(_mm256_andnot_ps(sign, dy),
+                                    _mm256_add_ps(ey, _mm256_add_ps(_mm256_mul_ps(hl, ay), _mm256_mul_ps(hw, ax))), _CMP_LE_OQ);
+        __m256 along = _mm256_add_ps(_mm256_mul_ps(dx, ux), _mm256_mul_ps(dy, uy));
+        __m256 on_long = _mm256_cmp_ps(_mm256_andnot_ps(sign, along),
+                                       _mm256_add_ps(hl, _mm256_add_ps(_mm256_mul_ps(ex, ax), _mm256_mul_ps(ey, ay))), _CMP_LE_OQ);
+        __m256 across = _mm256_sub_ps(_mm256_mul_ps(dx, uy), _mm256_mul_ps(dy, ux));
+        __m256 on_short = _mm256_cmp_ps(_mm256_andnot_ps(sign, across),
+                                        _mm256_add_ps(hw, _mm256_add_ps(_mm256_mul_ps(ex, ay), _mm256_mul_ps(ey, ax))), _CMP_LE_OQ);
+
+        int hits = _mm256_movemask_ps(_mm256_and_ps(_mm256_and_ps(on_x, on_y), _mm256_and_ps(on_long, on_short)));
+        if (hits)
+            return i + __builtin_ctz(hits);
+    }
+#if defined(__SSE2__)
+    return overlap_sse2(box, c, i, end);
+#else
+    return overlap_scalar(box, c, i, end);
+#endif
+}
+#endif
+
+typedef int (*OverlapKernel)(const Box &box, const ZapperColliders &c, size_t begin, size_t end);
+
+struct Kernel
+{
+    OverlapKernel run;
+    const char *name;
+};
+
+static Kernel pick_kernel()
+{
+    Kernel kernel = {overlap_scalar, "scalar"};
+#if defined(__SSE2__)
+    kernel.run = overlap_sse2;
+    kernel.name = "sse2";
+#endif
+#if defined(HAVE_AVX2_KERNEL)
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernel.run = overlap_avx2;
+        kernel.name = "avx2";
+    }
+#endif
+    return kernel;
+}
+
+// picked once on first use (thread safe), batch runs call this from every worker
+static const Kernel &active_kernel()
+{
+    static const Kernel kernel = pick_kernel();
+    return kernel;
+}
+
+int first_overlap(const Box &box, const ZapperColliders &colliders, size_t begin, size_t end)
+{
+    return active_kernel().run(box, colliders, begin, end);
+}
+
+int first_overlap(const Box &box, const ZapperColliders &colliders)
+{
+    return first_overlap(box, colliders, 0, colliders.size());
+}
+
+const char *collision_kernel()
+{
+    return active_kernel().name;
+}
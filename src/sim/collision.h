@@ -0,0 +1,53 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <cstddef>
+#include <vector>
+
+struct PlayerState;
+
+// Axis-aligned box given by centre and half extents (the player, coins).
+struct Box
+{
+    float x;
+    float y;
+    float half_x;
+    float half_y;
+};
+
+// Zappers as oriented boxes in structure-of-arrays form, so the narrow
+// phase can test 4 (SSE2) or 8 (AVX2) of them per instruction.
+// axis is the unit direction of the long side, as the zapper is drawn.
+struct ZapperColliders
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> axis_x;
+    std::vector<float> axis_y;
+    std::vector<float> half_length;
+    std::vector<float> half_width;
+
+    size_t size() const { return x.size(); }
+    void resize(size_t n);
+    // centre, rotation as drawn, and half extents along / across the long side
+    void set(size_t i, float x, float y, float rotation, float half_length, float half_width);
+    // half of the collider's width along x, for the broad phase
+    float reach_x(size_t i) const;
+    // copies the listed colliders of `from` into this one, in order
+    void gather(const ZapperColliders &from, const std::vector<int> &ids);
+};
+
+Box player_box(const PlayerState &player);
+
+bool box_overlap(const Box &a, const Box &b);
+
+// Exact oriented box vs axis aligned box (separating axis test), including
+// the zapper lying entirely inside the box. Returns the index of the first
+// overlapping collider in [begin, end), or -1.
+int first_overlap(const Box &box, const ZapperColliders &colliders, size_t begin, size_t end);
+int first_overlap(const Box &box, const ZapperColliders &colliders);
+
+// "avx2", "sse2" or "scalar", whichever first_overlap picked for this CPU
+const char *collision_kernel();
+
+#endif
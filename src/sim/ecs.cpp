@@ -0,0 +1,168 @@
+#include "ecs.h"
+
+// Every column with the component it belongs to; columns of components
+// the archetype doesn't have stay empty.
+#define COLUMNS(X)                 \
+    X(entity, true)                \
+    X(x, has(POSITION))            \
+    X(y, has(POSITION))            \
+    X(prev_x, has(POSITION))       \
+    X(prev_y, has(POSITION))       \
+    X(vx, has(VELOCITY))           \
+    X(vy, has(VELOCITY))           \
+    X(angle, has(ROTATION))        \
+    X(prev_angle, has(ROTATION))   \
+    X(spin, has(ROTATION))         \
+    X(offset_x, has(COLLIDER))     \
+    X(offset_y, has(COLLIDER))     \
+    X(half_x, has(COLLIDER))       \
+    X(half_y, has(COLLIDER))       \
+    X(mesh, has(RENDER))           \
+    X(pivot_x, has(RENDER))        \
+    X(pivot_y, has(RENDER))        \
+    X(spawn_id, has(RESPAWN))      \
+    X(respawns, has(RESPAWN))      \
+    X(collected, has(PICKUP))
+
+void Archetype::reserve(size_t n)
+{
+#define RESERVE(column, used) \
+    if (used)                 \
+        column.reserve(n);
+    COLUMNS(RESERVE)
+#undef RESERVE
+}
+
+void Archetype::clear()
+{
+#define CLEAR(column, used) column.clear();
+    COLUMNS(CLEAR)
+#undef CLEAR
+}
+
+size_t Archetype::add(Entity e)
+{
+#define ADD(column, used) \
+    if (used)             \
+        column.resize(column.size() + 1);
+    COLUMNS(ADD)
+#undef ADD
+    entity.back() = e;
+    return entity.size() - 1;
+}
+
+Entity Archetype::remove(size_t row)
+{
+#define REMOVE(column, used)          \
+    if (used)                         \
+    {                                 \
+        column[row] = column.back();  \
+        column.pop_back();            \
+    }
+    COLUMNS(REMOVE)
+#undef REMOVE
+    return row < entity.size() ? entity[row] : Entity();
+}
+
+uint32_t Registry::archetype(unsigned int mask)
+{
+    for (size_t i = 0; i < archetypes.size(); i++)
+    {
+        if (archetypes[i]->mask == mask)
+            return i;
+    }
+    archetypes.push_back(std::unique_ptr<Archetype>(new Archetype(mask)));
+    return archetypes.size() - 1;
+}
+
+Entity Registry::create(uint32_t archetype)
+{
+    Location location = {archetype, (uint32_t)archetypes[archetype]->size()};
+    Entity e = locations.spawn(location);
+    if (e.generation != 0)
+        archetypes[archetype]->add(e);
+    return e;
+}
+
+void Registry::destroy(Entity e)
+{
+    Location *location = locations.get(e);
+    if (!location)
+        return;
+    Entity moved = archetypes[location->archetype]->remove(location->row);
+    if (moved != e && locations.alive(moved))
+        locations.get(moved)->row = location->row;
+    locations.despawn(e);
+}
+
+void Registry::clear()
+{
+    locations.clear();
+    for (size_t i = 0; i < archetypes.size(); i++)
+        archetypes[i]->clear();
+}
+
+void movement_system(Registry &registry, double dt)
+{
+    for (size_t a = 0; a < registry.count(); a++)
+    {
+        Archetype &table = registry[a];
+        if (!table.has(POSITION | VELOCITY))
+            continue;
+        for (size_t i = 0; i < table.size(); i++)
+        {
+            table.prev_x[i] = table.x[i];
+            table.prev_y[i] = table.y[i];
+            table.x[i] += table.vx[i] * dt;
+            table.y[i] += table.vy[i] * dt;
+        }
+    }
+}
+
+void rotation_system(Registry &registry, double dt)
+{
+    for (size_t a = 0; a < registry.count(); a++)
+    {
+        Archetype &table = registry[a];
+        if (!table.has(ROTATION))
+            continue;
+        for (size_t i = 0; i < table.size(); i++)
+        {
+            table.prev_angle[i] = table.angle[i];
+            table.angle[i] += table.spin[i] * dt;
+        }
+    }
+}
+
+static float mix(float a, float b, float alpha)
+{
+    return a + (b - a) * alpha;
+}
+
+void render_system(const Registry &registry, float alpha, std::vector<DrawItem> &out)
+{
+    out.clear();
+    for (size_t a = 0; a < registry.count(); a++)
+    {
+        const Archetype &table = registry[a];
+        if (!table.has(POSITION | RENDER))
+            continue;
+        bool rotates = table.has(ROTATION);
+        bool pickups = table.has(PICKUP);
+        for (size_t i = 0; i < table.size(); i++)
+        {
+            // gone the moment it's collected, though it only respawns (or
+            // is destroyed) on the next tick
+            if (pickups && table.collected[i])
+                continue;
+            DrawItem item;
+            item.mesh = table.mesh[i];
+            item.x = mix(table.prev_x[i], table.x[i], alpha);
+            item.y = mix(table.prev_y[i], table.y[i], alpha);
+            item.rotation = rotates ? mix(table.prev_angle[i], table.angle[i], alpha) : 0;
+            item.pivot_x = item.x + table.pivot_x[i];
+            item.pivot_y = item.y + table.pivot_y[i];
+            out.push_back(item);
+        }
+    }
+}
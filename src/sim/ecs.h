@@ -0,0 +1,114 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include "pool.h"
+
+// A small entity-component store. Entities with the same set of components
+// share an archetype, which keeps every component field in its own tightly
+// packed array, so a system is a straight loop over a few float arrays
+// instead of a walk over whole objects.
+
+typedef Handle Entity;
+
+enum Component
+{
+    POSITION = 1 << 0, // x, y and their values last tick
+    VELOCITY = 1 << 1, // units per second
+    ROTATION = 1 << 2, // angle and spin in radians per second
+    COLLIDER = 1 << 3, // box half extents around position + offset
+    RENDER = 1 << 4,   // which mesh to draw, and the point it rotates about
+    RESPAWN = 1 << 5,  // comes back on the right edge instead of being destroyed
+    PICKUP = 1 << 6,   // collected by touching it (coins)
+    HAZARD = 1 << 7,   // kills by touching it (zappers)
+};
+
+enum Mesh
+{
+    MESH_COIN,
+    MESH_ZAPPER,
+};
+
+struct Archetype
+{
+    explicit Archetype(unsigned int mask) : mask(mask) {}
+
+    bool has(unsigned int components) const { return (mask & components) == components; }
+    size_t size() const { return entity.size(); }
+    void reserve(size_t n);
+    void clear();
+    // appends a zeroed row and returns it
+    size_t add(Entity e);
+    // moves the last row into `row`; returns the entity now at `row`, if any
+    Entity remove(size_t row);
+
+    unsigned int mask;
+    std::vector<Entity> entity;
+    // POSITION
+    std::vector<float> x, y, prev_x, prev_y;
+    // VELOCITY
+    std::vector<float> vx, vy;
+    // ROTATION
+    std::vector<float> angle, prev_angle, spin;
+    // COLLIDER
+    std::vector<float> offset_x, offset_y, half_x, half_y;
+    // RENDER
+    std::vector<int> mesh;
+    std::vector<float> pivot_x, pivot_y;
+    // RESPAWN
+    std::vector<uint32_t> spawn_id, respawns;
+    // PICKUP
+    std::vector<uint8_t> collected;
+};
+
+class Registry
+{
+public:
+    struct Location
+    {
+        uint32_t archetype;
+        uint32_t row;
+    };
+
+    // room for this many live entities; create() never allocates past it
+    void reserve(size_t entities) { locations.reserve(entities); }
+    // the archetype for exactly these components, made on first use
+    uint32_t archetype(unsigned int mask);
+
+    // null when full
+    Entity create(uint32_t archetype);
+    void destroy(Entity e);
+    bool alive(Entity e) const { return locations.alive(e); }
+    const Location *find(Entity e) const { return locations.get(e); }
+    void clear();
+
+    size_t size() const { return locations.size(); }
+    size_t count() const { return archetypes.size(); }
+    Archetype &operator[](size_t i) { return *archetypes[i]; }
+    const Archetype &operator[](size_t i) const { return *archetypes[i]; }
+
+private:
+    std::vector<std::unique_ptr<Archetype>> archetypes;
+    Pool<Location> locations;
+};
+
+// What the renderer needs of one entity, already interpolated.
+struct DrawItem
+{
+    int mesh;
+    float x;
+    float y;
+    float rotation;
+    float pivot_x; // absolute, the mesh rotates about this point
+    float pivot_y;
+};
+
+// Generic systems, run over every archetype that has the components.
+void movement_system(Registry &registry, double dt);
+void rotation_system(Registry &registry, double dt);
+void render_system(const Registry &registry, float alpha, std::vector<DrawItem> &out);
+
+#endif
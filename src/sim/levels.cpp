@@ -0,0 +1,70 @@
+#include <fstream>
+#include <sstream>
+
+#include "levels.h"
+
+std::vector<LevelDesc> default_levels()
+{
+    const float spin = 3.14159265f / 2;
+    std::vector<LevelDesc> levels;
+    for (int n = 1; n <= 3; n++)
+    {
+        LevelDesc level = {n, n, 0.6f, spin, -0.6f, 0.6f, -0.1f, 0.95f, 5 + 5 * n};
+        levels.push_back(level);
+    }
+    return levels;
+}
+
+bool load_levels(const std::string &path, std::vector<LevelDesc> &levels, std::string &error)
+{
+    std::ifstream file(path.c_str());
+    if (!file)
+    {
+        error = "could not open " + path;
+        return false;
+    }
+
+    std::vector<LevelDesc> loaded;
+    std::string line;
+    for (int number = 1; std::getline(file, line); number++)
+    {
+        size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue; // blank or comment only
+
+        // anything else has to be a level, so a typo is reported rather
+        // than dropping the row and renumbering the levels after it
+        std::istringstream fields(line);
+        LevelDesc level;
+        std::string rest;
+        if (!(fields >> level.coins >> level.zappers >> level.scroll_speed >> level.spin >> level.coin_low >> level.coin_high >>
+              level.zapper_low >> level.zapper_high >> level.length) ||
+            fields >> rest)
+        {
+            std::ostringstream message;
+            message << path << ":" << number << ": expected 9 numbers";
+            error = message.str();
+            return false;
+        }
+        if (level.coins < 0 || level.zappers < 0 || level.length <= 0 || level.coin_low > level.coin_high ||
+            level.zapper_low > level.zapper_high)
+        {
+            std::ostringstream message;
+            message << path << ":" << number << ": bad level";
+            error = message.str();
+            return false;
+        }
+        loaded.push_back(level);
+    }
+
+    if (loaded.empty())
+    {
+        error = path + " has no levels";
+        return false;
+    }
+    levels.swap(loaded);
+    return true;
+}
@@ -0,0 +1,29 @@
+#ifndef LEVELS_H
+#define LEVELS_H
+
+#include <string>
+#include <vector>
+
+// Everything that makes one level different from the next. The game plays
+// a table of these in order; see levels/levels.txt for the file format.
+struct LevelDesc
+{
+    int coins;
+    int zappers;
+    float scroll_speed; // units per second
+    float spin;         // radians per second of the first zapper, the n-th spins n times as fast
+    float coin_low;     // y range coins respawn in
+    float coin_high;
+    float zapper_low; // and zappers
+    float zapper_high;
+    int length; // distance that clears the level
+};
+
+// the three levels the game always had
+std::vector<LevelDesc> default_levels();
+
+// Reads a level table, one level per line. On failure `levels` is left
+// alone and `error` says which line was wrong.
+bool load_levels(const std::string &path, std::vector<LevelDesc> &levels, std::string &error);
+
+#endif
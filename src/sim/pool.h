@@ -0,0 +1,126 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+// Refers to an object in a Pool. Stays valid while the object lives and is
+// recognised as stale once it is despawned, even if the slot gets reused.
+struct Handle
+{
+    uint32_t index = 0;
+    uint32_t generation = 0; // 0 never names a live object
+
+    bool operator==(const Handle &other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle &other) const { return !(*this == other); }
+};
+
+// Fixed capacity object pool. Objects are packed at the front of one array
+// so systems loop over them with pool[0..size()); despawning moves the last
+// object into the hole. Handles go through a slot table with a free list,
+// so spawn and despawn are O(1) and never allocate once reserved.
+template <typename T>
+class Pool
+{
+public:
+    explicit Pool(size_t capacity = 0) { reserve(capacity); }
+
+    // the only call that allocates; existing handles stay valid
+    void reserve(size_t capacity)
+    {
+        if (capacity <= slots.size())
+            return;
+        items.reserve(capacity);
+        owners.reserve(capacity);
+        free_slots.reserve(capacity);
+        size_t first = slots.size();
+        for (size_t i = first; i < capacity; i++)
+        {
+            Slot slot = {0, 1};
+            slots.push_back(slot);
+        }
+        // lowest slots first out
+        for (size_t i = capacity; i-- > first;)
+            free_slots.push_back(i);
+    }
+
+    // a null handle when the pool is full
+    Handle spawn(const T &value)
+    {
+        Handle handle;
+        if (free_slots.empty())
+            return handle;
+        uint32_t index = free_slots.back();
+        free_slots.pop_back();
+
+        slots[index].dense = items.size();
+        items.push_back(value);
+        owners.push_back(index);
+
+        handle.index = index;
+        handle.generation = slots[index].generation;
+        return handle;
+    }
+
+    bool despawn(Handle handle)
+    {
+        if (!alive(handle))
+            return false;
+        Slot &slot = slots[handle.index];
+        uint32_t last = items.size() - 1;
+        items[slot.dense] = items[last];
+        owners[slot.dense] = owners[last];
+        slots[owners[slot.dense]].dense = slot.dense;
+        items.pop_back();
+        owners.pop_back();
+
+        if (++slot.generation == 0)
+            slot.generation = 1;
+        free_slots.push_back(handle.index);
+        return true;
+    }
+
+    void clear()
+    {
+        while (!items.empty())
+            despawn(handle_at(items.size() - 1));
+    }
+
+    bool alive(Handle handle) const
+    {
+        return handle.index < slots.size() && handle.generation == slots[handle.index].generation &&
+               slots[handle.index].dense < items.size() && owners[slots[handle.index].dense] == handle.index;
+    }
+
+    T *get(Handle handle) { return alive(handle) ? &items[slots[handle.index].dense] : NULL; }
+    const T *get(Handle handle) const { return alive(handle) ? &items[slots[handle.index].dense] : NULL; }
+
+    // dense access, i in [0, size()); positions change when objects despawn
+    size_t size() const { return items.size(); }
+    size_t capacity() const { return slots.size(); }
+    bool full() const { return free_slots.empty(); }
+    T &operator[](size_t i) { return items[i]; }
+    const T &operator[](size_t i) const { return items[i]; }
+    Handle handle_at(size_t i) const
+    {
+        Handle handle;
+        handle.index = owners[i];
+        handle.generation = slots[owners[i]].generation;
+        return handle;
+    }
+
+private:
+    struct Slot
+    {
+        uint32_t dense;      // position in items while alive
+        uint32_t generation; // bumped on despawn
+    };
+
+    std::vector<T> items;
+    std::vector<uint32_t> owners; // slot of each item
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+};
+
+#endif
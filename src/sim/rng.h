@@ -0,0 +1,76 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Counter-based random numbers (Philox4x32-10, Salmon et al. 2011).
+// The output is a pure function of (key, counter): there is no state to
+// advance, so any draw can be made on its own, in any order or thread,
+// and the same seed always lays out the same run.
+struct Philox
+{
+    uint32_t v[4];
+};
+
+inline Philox philox4x32(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, uint32_t k0, uint32_t k1)
+{
+    for (int round = 0; round < 10; round++)
+    {
+        uint64_t p0 = (uint64_t)0xD2511F53u * c0;
+        uint64_t p1 = (uint64_t)0xCD9E8D57u * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c0 = n0;
+        c1 = (uint32_t)p1;
+        c2 = n2;
+        c3 = (uint32_t)p0;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    Philox out = {{c0, c1, c2, c3}};
+    return out;
+}
+
+// Spawn positions for one run. Each draw is addressed by which kind of
+// object asks, the level, its index and how many times it has respawned, so
+// a respawn costs one hash and never depends on what other objects did
+// before it.
+class SpawnRng
+{
+public:
+    enum Stream
+    {
+        COIN = 1,
+        ZAPPER = 2,
+        TRACK = 3,
+    };
+
+    explicit SpawnRng(uint64_t seed = 0) { reseed(seed); }
+    void reseed(uint64_t seed)
+    {
+        key0 = (uint32_t)seed;
+        key1 = (uint32_t)(seed >> 32);
+    }
+
+    Philox draw(Stream stream, uint32_t level, uint32_t id, uint32_t respawn) const
+    {
+        return philox4x32(id, respawn, stream, level, key0, key1);
+    }
+
+    // uniform in [lo, hi) from the top 24 bits of one word
+    static float uniform(uint32_t word, float lo, float hi)
+    {
+        return lo + (hi - lo) * ((word >> 8) * (1.0f / 16777216.0f));
+    }
+
+    float uniform(Stream stream, uint32_t level, uint32_t id, uint32_t respawn, float lo, float hi) const
+    {
+        return uniform(draw(stream, level, id, respawn).v[0], lo, hi);
+    }
+
+private:
+    uint32_t key0;
+    uint32_t key1;
+};
+
+#endif
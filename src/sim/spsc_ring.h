@@ -0,0 +1,63 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+
+// Fixed size single-producer/single-consumer queue. One thread only
+// pushes, one only pops; neither ever takes a lock or blocks, a full or
+// empty ring just returns false. Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    bool push(const T &item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head == Capacity)
+        {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head == Capacity)
+                return false;
+        }
+        slots[t & (Capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cached_tail)
+        {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (h == cached_tail)
+                return false;
+        }
+        item = slots[h & (Capacity - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static const size_t cache_line = 64;
+
+    T slots[Capacity];
+    // the two ends live on their own cache lines, each with the producer's
+    // (or consumer's) last look at the other end so it rarely has to reload it.
+    // Padded apart rather than aligned, so a ring (or whatever holds one)
+    // needs no more than the usual alignment from new
+    char pad_slots[cache_line];
+    std::atomic<size_t> head;
+    size_t cached_tail = 0;
+    char pad_head[cache_line - 2 * sizeof(size_t)];
+    std::atomic<size_t> tail;
+    size_t cached_head = 0;
+    char pad_tail[cache_line - 2 * sizeof(size_t)];
+};
+
+#endif
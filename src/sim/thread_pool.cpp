@@ -0,0 +1,100 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(unsigned int threads) : next(0), queued(0), pending(0)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    for (unsigned int i = 0; i < threads; i++)
+        queues.emplace_back(new Queue());
+    for (unsigned int i = 0; i < threads; i++)
+        workers.emplace_back(&ThreadPool::run, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lk(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    pending++;
+    Queue &queue = *queues[next++ % queues.size()];
+    {
+        std::lock_guard<std::mutex> lk(queue.lock);
+        queue.tasks.push_back(std::move(task));
+    }
+    queued++;
+
+    std::lock_guard<std::mutex> lk(sleep_lock);
+    wake.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lk(sleep_lock);
+    idle.wait(lk, [this] { return pending == 0; });
+}
+
+bool ThreadPool::pop(unsigned int index, std::function<void()> &task)
+{
+    // own queue first, newest task (still warm in cache)
+    {
+        Queue &own = *queues[index];
+        std::lock_guard<std::mutex> lk(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+
+    // then steal the oldest task from someone else
+    for (size_t i = 1; i < queues.size(); i++)
+    {
+        Queue &victim = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lk(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::run(unsigned int index)
+{
+    while (true)
+    {
+        std::function<void()> task;
+        if (pop(index, task))
+        {
+            task();
+            if (--pending == 0)
+            {
+                std::lock_guard<std::mutex> lk(sleep_lock);
+                idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(sleep_lock);
+        wake.wait(lk, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0)
+            return;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool: every worker owns a deque and takes from its back,
+// idle workers steal from the front of the others.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned int threads = 0);
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+    // blocks until every submitted task has finished
+    void wait();
+    unsigned int size() const { return workers.size(); }
+
+private:
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void run(unsigned int index);
+    bool pop(unsigned int index, std::function<void()> &task);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::atomic<unsigned int> next;
+    std::atomic<int> queued;
+    std::atomic<int> pending;
+    bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef TIMESTEP_H
+#define TIMESTEP_H
+
+#include <cmath>
+
+// Accumulates real frame time and hands it out as whole fixed-size ticks,
+// so simulation speed does not depend on the frame rate.
+class FixedTimestep
+{
+public:
+    explicit FixedTimestep(double rate = 60.0) { set_rate(rate); }
+    // false, leaving the rate as it was, unless it's a positive number of
+    // ticks a second that gives a finite tick length
+    bool set_rate(double rate)
+    {
+        if (!(rate > 0) || !std::isfinite(rate) || !std::isfinite(1.0 / rate))
+            return false;
+        dt = 1.0 / rate;
+        return true;
+    }
+    void reset() { accumulator = 0; }
+
+    // Adds a frame's elapsed time and returns how many ticks are due.
+    // Long stalls are clamped so we don't try to catch up seconds at once,
+    // and no frame runs more than max_ticks, so a rate too high to keep up
+    // with slows the game down instead of taking longer every frame.
+    int advance(double frame_time)
+    {
+        if (frame_time > max_frame_time)
+            frame_time = max_frame_time;
+        accumulator += frame_time;
+
+        int ticks = 0;
+        while (accumulator >= dt && ticks < max_ticks)
+        {
+            accumulator -= dt;
+            ticks++;
+        }
+        if (ticks == max_ticks)
+            accumulator = std::fmod(accumulator, dt); // the time we gave up on
+        return ticks;
+    }
+
+    // Fraction of a tick left over, used to interpolate between the last two states.
+    float alpha() const { return accumulator / dt; }
+
+    double dt;
+    double accumulator = 0;
+    double max_frame_time = 0.25;
+    int max_ticks = 64;
+};
+
+#endif
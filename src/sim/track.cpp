@@ -0,0 +1,150 @@
+#include <chrono>
+
+#include "track.h"
+
+const float TrackGenerator::width = 2.0f;
+
+// coin y range and zapper y range, the same as respawns in level mode
+const float coin_low = -0.6f;
+const float coin_high = 0.6f;
+const float zapper_low = -0.1f;
+const float zapper_high = 0.95f;
+// zappers are drawn 0.45 below their y and spin, so keep coins out of the
+// circle they sweep (half length plus a coin and a bit of margin)
+const float zapper_offset_y = -0.45f;
+const float zapper_clearance = 0.15f + 0.032f + 0.05f;
+
+// Hands out the words of successive Philox blocks for one chunk.
+struct ChunkDraws
+{
+    const SpawnRng &rng;
+    uint64_t index;
+    uint32_t counter;
+    Philox block;
+    int used;
+
+    ChunkDraws(const SpawnRng &rng, uint64_t index) : rng(rng), index(index), counter(0), used(4) {}
+
+    uint32_t word()
+    {
+        if (used == 4)
+        {
+            block = rng.draw(SpawnRng::TRACK, (uint32_t)(index >> 32), (uint32_t)index, counter++);
+            used = 0;
+        }
+        return block.v[used++];
+    }
+
+    float uniform(float lo, float hi) { return SpawnRng::uniform(word(), lo, hi); }
+    int below(int n) { return (int)(((uint64_t)word() * n) >> 32); }
+};
+
+// coin patterns as offsets from their first coin
+struct Pattern
+{
+    int count;
+    float x[8];
+    float y[8];
+};
+
+static const Pattern patterns[] = {
+    {5, {0, 0.08f, 0.16f, 0.24f, 0.32f}, {0, 0, 0, 0, 0}},                                   // line
+    {7, {0, 0.08f, 0.16f, 0.24f, 0.32f, 0.4f, 0.48f}, {0, 0.06f, 0.1f, 0.12f, 0.1f, 0.06f, 0}}, // arc
+    {4, {0, 0, 0, 0}, {0, 0.08f, 0.16f, 0.24f}},                                             // column
+    {6, {0, 0.08f, 0.16f, 0, 0.08f, 0.16f}, {0, 0, 0, 0.08f, 0.08f, 0.08f}},                 // block
+};
+const int num_patterns = sizeof(patterns) / sizeof(patterns[0]);
+
+// chunks get harder every 4 (about 13 seconds), up to level 3
+static int difficulty(uint64_t index)
+{
+    return index < 4 ? 1 : index < 8 ? 2 : 3;
+}
+
+static bool clear_of_zappers(const Chunk &chunk, float x, float y)
+{
+    for (int i = 0; i < chunk.num_zappers; i++)
+    {
+        float dx = x - chunk.zappers[i].x;
+        float dy = y - (zapper_offset_y + chunk.zappers[i].y);
+        if (dx * dx + dy * dy < zapper_clearance * zapper_clearance)
+            return false;
+    }
+    return true;
+}
+
+void TrackGenerator::generate(uint64_t index, Chunk &chunk) const
+{
+    ChunkDraws draws(rng, index);
+    int hardest = difficulty(index);
+
+    chunk.index = index;
+
+    // one zapper per slot, so they never bunch up into a wall
+    chunk.num_zappers = hardest;
+    float slot = width / chunk.num_zappers;
+    for (int i = 0; i < chunk.num_zappers; i++)
+    {
+        ChunkZapper &zapper = chunk.zappers[i];
+        zapper.x = i * slot + draws.uniform(0.2f, slot - 0.2f);
+        zapper.y = draws.uniform(zapper_low, zapper_high);
+        zapper.level = 1 + draws.below(hardest);
+    }
+
+    // a coin pattern in each half, moved around until no coin sits in a
+    // zapper's way; dropped if no spot is found
+    chunk.num_coins = 0;
+    for (int half = 0; half < 2; half++)
+    {
+        const Pattern &pattern = patterns[draws.below(num_patterns)];
+        for (int attempt = 0; attempt < 8; attempt++)
+        {
+            float x = half * width / 2 + draws.uniform(0.1f, width / 2 - 0.6f);
+            float y = draws.uniform(coin_low, coin_high - 0.24f);
+
+            bool clear = true;
+            for (int i = 0; i < pattern.count && clear; i++)
+                clear = clear_of_zappers(chunk, x + pattern.x[i], y + pattern.y[i]);
+            if (!clear)
+                continue;
+
+            for (int i = 0; i < pattern.count && chunk.num_coins < Chunk::max_coins; i++)
+            {
+                ChunkCoin &coin = chunk.coins[chunk.num_coins++];
+                coin.x = x + pattern.x[i];
+                coin.y = y + pattern.y[i];
+            }
+            break;
+        }
+    }
+}
+
+ChunkStreamer::ChunkStreamer(uint64_t seed, uint64_t first)
+    : generator(seed), next(first), stopping(false)
+{
+    worker = std::thread(&ChunkStreamer::run, this);
+}
+
+ChunkStreamer::~ChunkStreamer()
+{
+    stopping = true;
+    worker.join();
+}
+
+void ChunkStreamer::run()
+{
+    while (!stopping)
+    {
+        Chunk chunk;
+        generator.generate(next, chunk);
+        // the ring holds several chunks (tens of seconds of track), so
+        // when it's full there's plenty of time to wait
+        while (!ring.push(chunk))
+        {
+            if (stopping)
+                return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        next++;
+    }
+}
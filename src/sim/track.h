@@ -0,0 +1,75 @@
+#ifndef TRACK_H
+#define TRACK_H
+
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+
+#include "rng.h"
+#include "spsc_ring.h"
+
+// Endless mode lays the track out in fixed width chunks. Chunk k covers
+// track positions [k * width, (k + 1) * width) and is a pure function of
+// (seed, k), so chunks are regenerated when needed instead of stored.
+
+struct ChunkCoin
+{
+    float x; // from the start of the chunk
+    float y;
+};
+
+struct ChunkZapper
+{
+    float x;
+    float y; // same range as a respawning zapper's y
+    int level; // spin speed
+};
+
+struct Chunk
+{
+    static const int max_coins = 32;
+    static const int max_zappers = 4;
+
+    uint64_t index;
+    int num_coins;
+    ChunkCoin coins[max_coins];
+    int num_zappers;
+    ChunkZapper zappers[max_zappers];
+};
+
+class TrackGenerator
+{
+public:
+    static const float width;
+
+    explicit TrackGenerator(uint64_t seed = 0) : rng(seed) {}
+    void reseed(uint64_t seed) { rng.reseed(seed); }
+    void generate(uint64_t index, Chunk &chunk) const;
+
+private:
+    SpawnRng rng;
+};
+
+// Generates chunks ahead of the game on its own thread and hands them over
+// through a lock-free ring, so the frame thread never waits on placement.
+// Chunks come out in order starting at `first`.
+class ChunkStreamer
+{
+public:
+    ChunkStreamer(uint64_t seed, uint64_t first);
+    ~ChunkStreamer();
+
+    // never blocks; false when the worker hasn't got that far yet
+    bool pop(Chunk &chunk) { return ring.pop(chunk); }
+
+private:
+    void run();
+
+    TrackGenerator generator;
+    uint64_t next;
+    SpscRing<Chunk, 8> ring;
+    std::atomic<bool> stopping;
+    std::thread worker;
+};
+
+#endif
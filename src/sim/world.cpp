@@ -0,0 +1,342 @@
+#include <random>
+
+#include "world.h"
+
+// endless mode never holds more than this many at once (a few dozen in practice)
+const size_t max_track_coins = 512;
+const size_t max_track_zappers = 64;
+
+const unsigned int coin_components = POSITION | VELOCITY | COLLIDER | RENDER | PICKUP;
+const unsigned int zapper_components = POSITION | VELOCITY | ROTATION | COLLIDER | RENDER | HAZARD;
+
+const float coin_size = 0.032f;
+const float zapper_centre_x = 0.77f;
+const float zapper_centre_y = -0.45f;
+const float zapper_half_width = 0.03f;
+const float zapper_half_length = 0.15f;
+
+// speeds are in units per second, tuned to match the old per-frame steps at 60 fps
+const float fly_speed = 1.8;
+
+static float mix(float a, float b, float alpha)
+{
+    return a + (b - a) * alpha;
+}
+
+void PlayerState::fly(double dt)
+{
+    if (y < 1.01)
+    {
+        y += fly_speed * dt;
+        abs_y += fly_speed * dt;
+    }
+}
+
+PlayerState PlayerState::lerp(float alpha) const
+{
+    PlayerState state = *this;
+    state.y = mix(prev_y, y, alpha);
+    state.abs_y = abs_y + (state.y - y);
+    return state;
+}
+
+World::World()
+{
+    // a fresh layout every game unless seed() is called
+    std::random_device rd;
+    seed((uint64_t)rd() << 32 | rd());
+}
+
+World::World(uint64_t value)
+{
+    seed(value);
+}
+
+void World::seed(uint64_t value)
+{
+    seed_value = value;
+    rng.reseed(value);
+    track.reseed(value);
+}
+
+void World::start_level(int setLevel)
+{
+    if (setLevel < 1)
+        setLevel = 1;
+    if (setLevel > (int)levels.size())
+        setLevel = levels.size();
+    level = setLevel;
+    params = levels[level - 1];
+    player = PlayerState();
+    velocity = 0;
+    time = 0;
+    move_x = 0;
+    prev_move_x = 0;
+    endless = false;
+    dead = false;
+    streamer.reset();
+
+    entities.clear();
+    entities.reserve(params.coins + params.zappers);
+    entities[entities.archetype(coin_components | RESPAWN)].reserve(params.coins);
+    entities[entities.archetype(zapper_components | RESPAWN)].reserve(params.zappers);
+
+    // everything starts at the origin; the i-th zapper spins i times as fast
+    for (int i = 0; i < params.coins; i++)
+        spawn_coin(true, i, 0, 0);
+    for (int i = 0; i < params.zappers; i++)
+        spawn_zapper(true, i, 0, 0, i + 1);
+}
+
+void World::start_endless(bool background)
+{
+    start_level(1);
+    level = 0;
+    endless = true;
+    entities.clear();
+    entities.reserve(max_track_coins + max_track_zappers);
+    entities[entities.archetype(coin_components)].reserve(max_track_coins);
+    entities[entities.archetype(zapper_components)].reserve(max_track_zappers);
+    next_chunk = 0;
+    scrolled = 0;
+    if (background)
+        streamer.reset(new ChunkStreamer(seed_value, next_chunk));
+}
+
+Entity World::spawn_coin(bool respawns, uint32_t id, float x, float y)
+{
+    Entity e = entities.create(entities.archetype(coin_components | (respawns ? RESPAWN : 0)));
+    const Registry::Location *at = entities.find(e);
+    if (!at)
+        return e; // full
+    Archetype &table = entities[at->archetype];
+    size_t i = at->row;
+    table.x[i] = table.prev_x[i] = x;
+    table.y[i] = table.prev_y[i] = y;
+    table.vx[i] = -params.scroll_speed;
+    table.half_x[i] = table.half_y[i] = coin_size;
+    table.mesh[i] = MESH_COIN;
+    if (respawns)
+        table.spawn_id[i] = id;
+    return e;
+}
+
+Entity World::spawn_zapper(bool respawns, uint32_t id, float x, float y, int spin_level)
+{
+    Entity e = entities.create(entities.archetype(zapper_components | (respawns ? RESPAWN : 0)));
+    const Registry::Location *at = entities.find(e);
+    if (!at)
+        return e;
+    Archetype &table = entities[at->archetype];
+    size_t i = at->row;
+    table.x[i] = table.prev_x[i] = x;
+    table.y[i] = table.prev_y[i] = y;
+    table.vx[i] = -params.scroll_speed;
+    table.spin[i] = spin_level * params.spin;
+    // the sprite is modelled around (0.77, -0.45), which is where x, y = 0 draws it
+    table.offset_x[i] = table.pivot_x[i] = zapper_centre_x;
+    table.offset_y[i] = table.pivot_y[i] = zapper_centre_y;
+    table.half_x[i] = zapper_half_width;
+    table.half_y[i] = zapper_half_length;
+    table.mesh[i] = MESH_ZAPPER;
+    if (respawns)
+        table.spawn_id[i] = id;
+    return e;
+}
+
+float World::background(float alpha) const
+{
+    return mix(prev_move_x, move_x, alpha);
+}
+
+void World::step(const Input &input, double dt)
+{
+    player.prev_y = player.y;
+    prev_move_x = move_x;
+
+    if (input.fly)
+    {
+        player.fly(dt);
+        velocity = 0;
+    }
+
+    move_x -= params.scroll_speed * dt;
+    scrolled += params.scroll_speed * dt;
+
+    velocity += gravity * dt;
+    if (player.y > 0)
+    {
+        player.y -= velocity * dt * 0.4;
+        player.abs_y -= velocity * dt * 0.4;
+    }
+    time += dt;
+
+    if (endless)
+    {
+        cull();
+        feed_track();
+    }
+
+    movement_system(entities, dt);
+    rotation_system(entities, dt);
+    if (!endless)
+        respawn();
+    collide();
+}
+
+// Level mode: a collected coin, or anything that scrolled off the left,
+// comes back on the right edge at a random height.
+void World::respawn()
+{
+    for (size_t a = 0; a < entities.count(); a++)
+    {
+        Archetype &table = entities[a];
+        if (!table.has(RESPAWN))
+            continue;
+
+        if (table.has(PICKUP))
+        {
+            for (size_t i = 0; i < table.size(); i++)
+            {
+                if (!table.collected[i] && table.x[i] >= -1.1)
+                    continue;
+                table.x[i] = 1.1;
+                table.y[i] = rng.uniform(SpawnRng::COIN, level, table.spawn_id[i], table.respawns[i]++, params.coin_low, params.coin_high);
+                table.collected[i] = 0;
+                // teleports are not interpolated
+                table.prev_x[i] = table.x[i];
+                table.prev_y[i] = table.y[i];
+            }
+        }
+        else if (table.has(HAZARD))
+        {
+            for (size_t i = 0; i < table.size(); i++)
+            {
+                if (table.x[i] >= -1.8)
+                    continue;
+                table.x[i] = 0.5;
+                table.y[i] = rng.uniform(SpawnRng::ZAPPER, level, table.spawn_id[i], table.respawns[i]++, params.zapper_low, params.zapper_high);
+                table.prev_x[i] = table.x[i];
+                table.prev_y[i] = table.y[i];
+            }
+        }
+    }
+}
+
+// Collision system: every pickup and hazard goes into its broad phase and
+// only those whose x-span overlaps the player's reach the narrow phase.
+void World::collide()
+{
+    Box box = player_box(player);
+    float min_x = box.x - box.half_x;
+    float max_x = box.x + box.half_x;
+
+    pickups.clear();
+    zapper_colliders.resize(0);
+    for (size_t a = 0; a < entities.count(); a++)
+    {
+        Archetype &table = entities[a];
+        if (!table.has(POSITION | COLLIDER))
+            continue;
+        if (table.has(PICKUP))
+        {
+            for (size_t i = 0; i < table.size(); i++)
+            {
+                Registry::Location at = {(uint32_t)a, (uint32_t)i};
+                pickups.push_back(at);
+            }
+        }
+        else if (table.has(HAZARD | ROTATION))
+        {
+            size_t first = zapper_colliders.size();
+            zapper_colliders.resize(first + table.size());
+            for (size_t i = 0; i < table.size(); i++)
+                zapper_colliders.set(first + i, table.x[i] + table.offset_x[i], table.y[i] + table.offset_y[i],
+                                     table.angle[i], table.half_y[i], table.half_x[i]);
+        }
+    }
+
+    coin_broadphase.resize(pickups.size());
+    for (size_t id = 0; id < pickups.size(); id++)
+    {
+        const Archetype &table = entities[pickups[id].archetype];
+        size_t i = pickups[id].row;
+        float x = table.x[i] + table.offset_x[i];
+        coin_broadphase.set(id, x - table.half_x[i], x + table.half_x[i]);
+    }
+    coin_broadphase.sort();
+    candidates.clear();
+    coin_broadphase.query(min_x, max_x, candidates);
+    for (size_t c = 0; c < candidates.size(); c++)
+    {
+        Archetype &table = entities[pickups[candidates[c]].archetype];
+        size_t i = pickups[candidates[c]].row;
+        Box coin = {table.x[i] + table.offset_x[i], table.y[i] + table.offset_y[i], table.half_x[i], table.half_y[i]};
+        if (box_overlap(box, coin))
+        {
+            table.collected[i] = 1;
+            coins_collected++;
+        }
+    }
+
+    zapper_broadphase.resize(zapper_colliders.size());
+    for (size_t id = 0; id < zapper_colliders.size(); id++)
+    {
+        float reach = zapper_colliders.reach_x(id);
+        zapper_broadphase.set(id, zapper_colliders.x[id] - reach, zapper_colliders.x[id] + reach);
+    }
+    zapper_broadphase.sort();
+    candidates.clear();
+    zapper_broadphase.query(min_x, max_x, candidates);
+    nearby.gather(zapper_colliders, candidates);
+    if (first_overlap(box, nearby) >= 0)
+        dead = true;
+}
+
+// endless mode: collected or passed objects are destroyed instead of respawned
+void World::cull()
+{
+    for (size_t a = 0; a < entities.count(); a++)
+    {
+        Archetype &table = entities[a];
+        if (table.has(RESPAWN))
+            continue;
+        double left = table.has(HAZARD) ? -1.8 : -1.1;
+        for (size_t i = 0; i < table.size();)
+        {
+            bool gone = table.x[i] < left || (table.has(PICKUP) && table.collected[i]);
+            if (gone)
+                entities.destroy(table.entity[i]); // the last row moves into i
+            else
+                i++;
+        }
+    }
+}
+
+// Spawns every chunk whose start has reached the right edge of the screen.
+// Chunks come from the streamer when it has them ready, otherwise they are
+// generated here; both give the same chunk for the same index.
+void World::feed_track()
+{
+    const float right_edge = 1.2f;
+
+    while (next_chunk * TrackGenerator::width <= scrolled)
+    {
+        // anything older than next_chunk was already generated here while
+        // the worker was behind
+        bool ready = false;
+        while (!ready && streamer && streamer->pop(chunk))
+            ready = chunk.index == next_chunk;
+        if (!ready)
+            track.generate(next_chunk, chunk);
+
+        // spawns past the reserved capacity are dropped
+        float start = right_edge + (float)(next_chunk * TrackGenerator::width - scrolled);
+        for (int i = 0; i < chunk.num_coins; i++)
+            spawn_coin(false, 0, start + chunk.coins[i].x, chunk.coins[i].y);
+        // a zapper's x is measured from where it is drawn at x = 0
+        for (int i = 0; i < chunk.num_zappers; i++)
+            spawn_zapper(false, 0, start + chunk.zappers[i].x - zapper_centre_x, chunk.zappers[i].y, chunk.zappers[i].level);
+        next_chunk++;
+    }
+}
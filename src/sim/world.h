@@ -0,0 +1,97 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+#include "broadphase.h"
+#include "collision.h"
+#include "ecs.h"
+#include "levels.h"
+#include "rng.h"
+#include "track.h"
+
+// Everything in src/sim is free of GL/GLFW so the game can be stepped
+// without a window. The renderer only reads these structs.
+
+struct Input
+{
+    bool fly = false;
+};
+
+// The player keeps its value from the previous tick so the renderer can
+// draw lerp(alpha) in between two fixed ticks; coins and zappers are
+// entities and keep theirs in their POSITION and ROTATION components.
+
+struct PlayerState
+{
+    float abs_x = -0.72f;
+    float abs_y = -0.5f;
+    float y = 0;
+    float prev_y = 0;
+    float size_x = 0.08f;
+    float size_y = 0.1f;
+    void fly(double dt);
+    PlayerState lerp(float alpha) const;
+};
+
+class World
+{
+public:
+    World();
+    // seeded up front, without drawing on the system's entropy
+    explicit World(uint64_t value);
+    // the whole run (every respawn and track chunk) follows from this one value
+    void seed(uint64_t value);
+    // plays levels[setLevel - 1]; can be called mid-game to move on in place
+    void start_level(int setLevel);
+    // Endless track built from chunks instead of respawning a fixed set.
+    // With `background` the chunks are generated ahead on a worker thread,
+    // otherwise (batch runs) on demand; the result is the same either way.
+    void start_endless(bool background);
+    void step(const Input &input, double dt);
+    int distance() const { return (int)time; }
+    bool cleared() const { return !endless && distance() >= params.length; }
+    float background(float alpha) const;
+    // everything to draw this frame, interpolated
+    void submit(float alpha, std::vector<DrawItem> &out) const { render_system(entities, alpha, out); }
+
+    std::vector<LevelDesc> levels = default_levels();
+    LevelDesc params; // the level being played
+
+    PlayerState player;
+    Registry entities;
+    ZapperColliders zapper_colliders;
+    SweepAndPrune coin_broadphase;
+    SweepAndPrune zapper_broadphase;
+    double velocity = 0;
+    double gravity = 9.8;
+    double time = 0;
+    float move_x = 0;
+    float prev_move_x = 0;
+    int coins_collected = 0;
+    int level = 1;
+    bool endless = false;
+    bool dead = false;
+
+private:
+    Entity spawn_coin(bool respawns, uint32_t id, float x, float y);
+    Entity spawn_zapper(bool respawns, uint32_t id, float x, float y, int spin_level);
+    void respawn();
+    void collide();
+    void cull();
+    void feed_track();
+    uint64_t seed_value;
+    SpawnRng rng;
+    TrackGenerator track;
+    std::unique_ptr<ChunkStreamer> streamer;
+    uint64_t next_chunk = 0;
+    double scrolled = 0; // track distance covered, for placing chunks
+    Chunk chunk;
+    std::vector<Registry::Location> pickups; // broad phase id -> entity row
+    std::vector<int> candidates;
+    ZapperColliders nearby;
+};
+
+#endif
@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 BrightColor;
+
+in vec2 TexCoord;
+flat in float Layer;
+flat in float Glow;
+
+uniform sampler2DArray sprites;
+
+void main()
+{
+    FragColor = texture(sprites, vec3(TexCoord, Layer));
+    BrightColor = vec4(FragColor.rgb * Glow, FragColor.a);
+}
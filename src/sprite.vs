@@ -0,0 +1,15 @@
+#version 330 core
+layout (location = 0) in vec4 aPosTex; // xy position, zw texture coordinate
+layout (location = 1) in vec2 aLayerGlow;
+
+out vec2 TexCoord;
+flat out float Layer;
+flat out float Glow;
+
+void main()
+{
+    gl_Position = vec4(aPosTex.xy, 0.0, 1.0);
+    TexCoord = aPosTex.zw;
+    Layer = aLayerGlow.x;
+    Glow = aLayerGlow.y;
+}
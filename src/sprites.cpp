@@ -0,0 +1,119 @@
+#include "main.h"
+#include "sprites.h"
+
+TextureArray SpriteBatch::read(const char *cooked, const char *const paths[], int count, bool compressed)
+{
+    TextureArray texture;
+    std::string error;
+    if (read_ktx(cooked, texture, error) && texture.layers == count && (compressed || !texture.compressed()))
+        return texture;
+    if (!build_texture_array(std::vector<std::string>(paths, paths + count), true, COMPRESS_NONE, texture, error))
+        std::cout << "Failed to load texture" << std::endl;
+    return texture;
+}
+
+void SpriteBatch::setup(const TextureArray &texture)
+{
+    layer_width = texture.width;
+    layer_height = texture.height;
+    int levels = texture.levels.size();
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, array);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    extents.resize(texture.layers);
+    for (int i = 0; i < texture.layers; i++)
+        extents[i] = glm::vec2(texture.extents[2 * i], texture.extents[2 * i + 1]);
+}
+
+// points the attributes of the bound VAO at vertices written to the stream
+// at offset
+static void point_attributes(unsigned int buffer, size_t offset)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    // position and texture coordinate
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void *)offset);
+    // layer and glow
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void *)(offset + offsetof(SpriteVertex, layer)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteBatch::createVAO(StreamBuffer &stream)
+{
+    this->stream = &stream;
+    glGenTextures(1, &array);
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    point_attributes(stream.ID, 0);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+}
+
+void SpriteBatch::add(int sprite, int layer, const glm::vec2 corners[4], glm::vec2 uv0, glm::vec2 uv1, bool glow)
+{
+    uv0 *= extents[sprite];
+    uv1 *= extents[sprite];
+    SpriteVertex quad[4] = {
+        {corners[0].x, corners[0].y, uv0.x, uv0.y, (float)sprite, glow ? 1.0f : 0.0f},
+        {corners[1].x, corners[1].y, uv1.x, uv0.y, (float)sprite, glow ? 1.0f : 0.0f},
+        {corners[2].x, corners[2].y, uv1.x, uv1.y, (float)sprite, glow ? 1.0f : 0.0f},
+        {corners[3].x, corners[3].y, uv0.x, uv1.y, (float)sprite, glow ? 1.0f : 0.0f}};
+    // two triangles
+    vertices.push_back(quad[0]);
+    vertices.push_back(quad[1]);
+    vertices.push_back(quad[2]);
+    vertices.push_back(quad[0]);
+    vertices.push_back(quad[2]);
+    vertices.push_back(quad[3]);
+    Quad placed = {layer, glow};
+    quads.push_back(placed);
+}
+
+void SpriteBatch::add(int sprite, int layer, const glm::vec2 corners[4], bool glow)
+{
+    add(sprite, layer, corners, glm::vec2(0.0f), glm::vec2(1.0f), glow);
+}
+
+void SpriteBatch::add(int sprite, int layer, glm::vec2 lo, glm::vec2 hi, bool glow)
+{
+    glm::vec2 corners[4] = {lo, glm::vec2(hi.x, lo.y), hi, glm::vec2(lo.x, hi.y)};
+    add(sprite, layer, corners, glow);
+}
+
+void SpriteBatch::add_scrolling(int sprite, int layer, float scroll, bool glow)
+{
+    // the left edge of the screen shows the image at s; where it runs out
+    // the start of the image follows, as a second quad
+    float s = -scroll - std::floor(-scroll);
+    float split = -1.0f + 2.0f * (1.0f - s);
+    glm::vec2 left[4] = {glm::vec2(-1.0f, -1.0f), glm::vec2(split, -1.0f), glm::vec2(split, 1.0f), glm::vec2(-1.0f, 1.0f)};
+    add(sprite, layer, left, glm::vec2(s, 0.0f), glm::vec2(1.0f, 1.0f), glow);
+    if (s > 0.0f)
+    {
+        glm::vec2 right[4] = {glm::vec2(split, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(split, 1.0f)};
+        add(sprite, layer, right, glm::vec2(0.0f, 0.0f), glm::vec2(s, 1.0f), glow);
+    }
+}
+
+void SpriteBatch::submit(RenderQueue &queue, Shader &shader)
+{
+    if (quads.empty())
+        return;
+    size_t offset = stream->write(vertices.data(), vertices.size() * sizeof(SpriteVertex));
+    glBindVertexArray(VAO);
+    point_attributes(stream->ID, offset);
+    glBindVertexArray(0);
+
+    for (size_t i = 0; i < quads.size(); i++)
+    {
+        queue.submit(PASS_SCENE, quads[i].layer, shader, GL_TEXTURE_2D_ARRAY, array, VAO, GL_TRIANGLES, false, i * 6, 6);
+        if (quads[i].glow)
+            queue.submit(PASS_BRIGHT, quads[i].layer, shader, GL_TEXTURE_2D_ARRAY, array, VAO, GL_TRIANGLES, false, i * 6, 6);
+    }
+}
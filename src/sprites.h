@@ -0,0 +1,91 @@
+#include "main.h"
+#include "shader.h"
+#include "render_queue.h"
+#include "stream.h"
+#include "assets/texture.h"
+
+#ifndef SPRITES_H
+#define SPRITES_H
+
+// The images sprites are drawn with, one layer of the texture array each,
+// in the order of sprite_files in main, which SpriteBatch::read() decodes
+// when there is no cooked file, and of SPRITE_IMAGES in CMakeLists.txt,
+// which the cook step lays sprites.ktx out from.
+enum Sprite
+{
+    SPRITE_BACKGROUND,
+    SPRITE_PLAYER,
+    SPRITE_ZAPPER,
+    NUM_SPRITES
+};
+
+// One corner of a sprite quad; sprite.vs reads where it is, which texel of
+// which layer it shows and whether it glows, so every sprite of the frame,
+// whatever its image, goes into the same buffer.
+struct SpriteVertex
+{
+    float x;
+    float y;
+    float u;
+    float v;
+    float layer;
+    float glow; // multiplies the bright pass output, 0 or 1
+};
+
+// Every textured quad of the frame. The images share one GL_TEXTURE_2D_ARRAY
+// whose layers are as large as the largest image; a smaller image sits in
+// the bottom left of its layer with its edge texels repeated out to the
+// border, and its quads' texture coordinates are scaled to match.
+// read() gets the array's texels, mipmaps and all, from the file the cook
+// tool laid out ahead of time or, without one, by decoding the images; it
+// touches no GL, so it can run off the GL thread while an AssetLoader
+// uploads the result into `array` and setup() then samples it.
+// add() appends quads in normalized device coordinates on a RenderLayer,
+// submit() sends the frame's quads to the GPU once and queues a packet for
+// each, and one for the bright pass of each glowing one. They all share
+// their state, so the queue draws every run of them between two other
+// draws with a single call.
+class SpriteBatch
+{
+public:
+    unsigned int array;
+    int layer_width;
+    int layer_height;
+
+    // the cooked file unless it is missing, holds another number of layers
+    // or is compressed when the GL can't sample compressed texels
+    static TextureArray read(const char *cooked, const char *const paths[], int count, bool compressed);
+    // names `array`; the quads are streamed through `stream` every frame
+    void createVAO(StreamBuffer &stream);
+    // once the texels are in `array`
+    void setup(const TextureArray &texture);
+    void clear()
+    {
+        vertices.clear();
+        quads.clear();
+    }
+    // corners go counter-clockwise from the bottom left of the image
+    void add(int sprite, int layer, const glm::vec2 corners[4], bool glow);
+    void add(int sprite, int layer, glm::vec2 lo, glm::vec2 hi, bool glow);
+    // the whole screen, showing the image at texture coordinates minus
+    // (scroll, 0), wrapping around
+    void add_scrolling(int sprite, int layer, float scroll, bool glow);
+    void submit(RenderQueue &queue, Shader &shader);
+
+private:
+    struct Quad
+    {
+        int layer;
+        bool glow;
+    };
+
+    void add(int sprite, int layer, const glm::vec2 corners[4], glm::vec2 uv0, glm::vec2 uv1, bool glow);
+
+    unsigned int VAO;
+    StreamBuffer *stream;
+    std::vector<glm::vec2> extents; // part of its layer each image covers
+    std::vector<SpriteVertex> vertices;
+    std::vector<Quad> quads; // six vertices each
+};
+
+#endif
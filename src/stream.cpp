@@ -0,0 +1,128 @@
+#include "main.h"
+#include "stream.h"
+#include "extensions.h"
+
+// ARB_buffer_storage is GL 4.4, past what the bundled glad loader covers,
+// so its entry point and flags are fetched from the context by hand
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+typedef void (*BufferStorage)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+static BufferStorage glBufferStorage = NULL;
+
+// does [a, b) overlap the range, wrapped or not
+static bool overlaps(size_t a, size_t b, size_t start, size_t end)
+{
+    if (start <= end)
+        return a < end && start < b;
+    return a < end || b > start;
+}
+
+void StreamBuffer::create(size_t frame_bytes)
+{
+    if (has_extension("GL_ARB_buffer_storage"))
+        glBufferStorage = (BufferStorage)glfwGetProcAddress("glBufferStorage");
+    persistent = glBufferStorage != NULL;
+    ID = 0;
+    renew(frame_bytes * frames_in_flight);
+}
+
+// a new buffer object, not new storage for the old one: draws queued but not
+// yet issued this frame still point at the old one, which GL keeps alive
+// until nothing refers to it
+void StreamBuffer::renew(size_t new_size)
+{
+    for (size_t i = 0; i < inflight.size(); i++)
+        glDeleteSync(inflight[i].fence);
+    inflight.clear();
+    head = 0;
+    frame_start = 0;
+    size = new_size;
+
+    if (ID)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, ID);
+        if (persistent)
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        glDeleteBuffers(1, &ID);
+    }
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_ARRAY_BUFFER, ID);
+    if (persistent)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+        mapped = (unsigned char *)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+    }
+    else
+        glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// forgets the ranges of frames the GPU has finished with; never blocks
+void StreamBuffer::retire()
+{
+    while (!inflight.empty())
+    {
+        GLenum status = glClientWaitSync(inflight.front().fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        glDeleteSync(inflight.front().fence);
+        inflight.pop_front();
+    }
+}
+
+bool StreamBuffer::busy(size_t start, size_t end) const
+{
+    // this frame's own range may not close into a full circle either, it
+    // would then read as empty
+    if (frame_start != head && (overlaps(start, end, frame_start, head) || end == frame_start))
+        return true;
+    for (size_t i = 0; i < inflight.size(); i++)
+    {
+        if (overlaps(start, end, inflight[i].start, inflight[i].end))
+            return true;
+    }
+    return false;
+}
+
+size_t StreamBuffer::write(const void *data, size_t bytes)
+{
+    retire();
+    size_t start = (head + alignment - 1) / alignment * alignment;
+    if (start + bytes > size)
+        start = 0;
+    if (bytes > size || busy(start, start + bytes))
+    {
+        renew(std::max(size * 2, bytes * frames_in_flight));
+        renewals++;
+        start = 0;
+    }
+    head = start + bytes;
+
+    if (persistent)
+    {
+        memcpy(mapped + start, data, bytes);
+        return start;
+    }
+    // the fences already keep the GPU off this range, so the driver needn't
+    glBindBuffer(GL_ARRAY_BUFFER, ID);
+    void *range = glMapBufferRange(GL_ARRAY_BUFFER, start, bytes, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    memcpy(range, data, bytes);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return start;
+}
+
+void StreamBuffer::end_frame()
+{
+    if (head == frame_start)
+        return;
+    Range range;
+    range.start = frame_start;
+    range.end = head;
+    range.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    inflight.push_back(range);
+    frame_start = head;
+}
@@ -0,0 +1,55 @@
+#include "main.h"
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <deque>
+
+// One large vertex buffer that every piece of per-frame geometry (sprites,
+// coin instances, text) is written into, one range after the other, wrapping
+// around at the end. Each frame's ranges are fenced when it ends, and a range
+// is only written again once the GPU has passed its fence, so no write ever
+// waits on a draw still reading the buffer. Where ARB_buffer_storage exists
+// the buffer is mapped once, persistently, and writes are plain copies;
+// otherwise each write maps its range unsynchronized. If the frames still in
+// flight leave no room, the buffer is swapped for a fresh one twice the size
+// rather than waiting, so it settles at what the game actually streams.
+// Offsets move every frame, so users point their attributes at the offset
+// write() returns each time.
+class StreamBuffer
+{
+public:
+    static const int frames_in_flight = 3;
+    static const size_t alignment = 16;
+
+    unsigned int ID;
+    size_t size;
+    bool persistent;
+    int renewals = 0; // times the buffer ran out of room, for profiling
+
+    // room for frames_in_flight frames of frame_bytes each
+    void create(size_t frame_bytes);
+    // copies data into the buffer, returns the offset it landed at
+    size_t write(const void *data, size_t bytes);
+    // after the frame's last draw
+    void end_frame();
+
+private:
+    struct Range
+    {
+        size_t start;
+        size_t end; // before start if the range wrapped
+        GLsync fence;
+    };
+
+    void renew(size_t size);
+    void retire();
+    bool busy(size_t start, size_t end) const;
+
+    unsigned char *mapped = NULL;
+    size_t head = 0;        // where the next write goes
+    size_t frame_start = 0; // where this frame's writes began
+    std::deque<Range> inflight;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "main.h"
 #include "structure.h"
+#include "uniforms.h"
 
 void Floor::createVAO()
 {
@@ -33,16 +34,12 @@ void Floor::createVAO()
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void Floor::draw(unsigned int shaderProgram)
+void Floor::draw(Shader &shader)
 {
-    glUseProgram(shaderProgram);
+    shader.use();
     trans = glm::mat4(1.0f);
-
-    unsigned int transformLoc = glGetUniformLocation(shaderProgram, "transform");
-    glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(trans));
-
-    int vertexColorLocation = glGetUniformLocation(shaderProgram, "col");
-    glUniform4f(vertexColorLocation, 0.5f, 0.0f, 1.0f, 1.0f);
+    shader.set(U_TRANSFORM, trans);
+    shader.set(U_COL, glm::vec4(0.5f, 0.0f, 1.0f, 1.0f));
 
     glBindVertexArray(VAO); // seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
@@ -81,16 +78,12 @@ void Ceiling::createVAO()
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void Ceiling::draw(unsigned int shaderProgram)
+void Ceiling::draw(Shader &shader)
 {
-    glUseProgram(shaderProgram);
+    shader.use();
     trans = glm::mat4(1.0f);
-
-    unsigned int transformLoc = glGetUniformLocation(shaderProgram, "transform");
-    glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(trans));
-
-    int vertexColorLocation = glGetUniformLocation(shaderProgram, "col");
-    glUniform4f(vertexColorLocation, 0.5f, 0.0f, 1.0f, 1.0f);
+    shader.set(U_TRANSFORM, trans);
+    shader.set(U_COL, glm::vec4(0.5f, 0.0f, 1.0f, 1.0f));
 
     glBindVertexArray(VAO); // seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
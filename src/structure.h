@@ -1,4 +1,5 @@
 #include "main.h"
+#include "shader.h"
 
 #ifndef STRUCTURE_H
 #define STRUCTURE_H
@@ -10,7 +11,7 @@ public:
     void createVAO();
     glm::mat4 trans;
     Floor() { trans = glm::mat4(1.0f); }
-    void draw(unsigned int shaderProgram);
+    void draw(Shader &shader);
 };
 
 class Ceiling
@@ -20,7 +21,7 @@ public:
     void createVAO();
     glm::mat4 trans;
     Ceiling() { trans = glm::mat4(1.0f); }
-    void draw(unsigned int shaderProgram);
+    void draw(Shader &shader);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "main.h"
+#include "bloom.h"
+
+#ifndef TARGETS_H
+#define TARGETS_H
+
+// The offscreen targets the scene is drawn into before it is tone mapped.
+// FULL is the layout the renderer started with: two RGBA16F attachments, the
+// scene and its bright pass, side by side at full resolution, and a depth
+// buffer. LEAN stores colour as packed R11F_G11F_B10F (nothing reads the
+// alpha of these targets), keeps only the scene attachment and leaves out
+// the depth buffer, which no pass tests against. The bright pass is drawn
+// instead by drawing the glowing things a second time, at half resolution,
+// straight into the top level of the bloom, which saves the bloom its first
+// downsample too. --framebuffers picks one so the two can be compared.
+class FrameTargets
+{
+public:
+    enum Mode
+    {
+        FULL,
+        LEAN
+    };
+
+    Mode mode = LEAN;
+    unsigned int scene;  // texture hdr.fs tone maps
+    unsigned int bright; // texture the bloom starts from
+    size_t bytes = 0;    // memory of the targets, for profiling
+
+    // the colour format every target should use, the bloom's included
+    GLenum format() const { return mode == LEAN ? GL_R11F_G11F_B10F : GL_RGBA16F; }
+    // after bloom.create(), whose top level LEAN draws the bright pass to
+    void create(int width, int height, const Bloom &bloom);
+    // binds and clears the scene target; under FULL the scene's draws write
+    // the bright pass as well
+    void begin_scene();
+    // under LEAN binds and clears the half resolution bright target for the
+    // glowing draws to be drawn again; false under FULL, where the scene
+    // pass wrote it already
+    bool begin_bright();
+
+private:
+    int half_width;
+    int half_height;
+    unsigned int sceneFBO;
+    unsigned int brightFBO;
+};
+
+#endif
@@ -0,0 +1,543 @@
+#include "main.h"
+#include "text.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Baked font cache: the atlas and metrics Text::prepare produced last time,
+// kept in the working directory so later launches map
+// the file and upload it instead of running FreeType.
+struct FontCacheHeader
+{
+    char magic[8];       // "JJFONT1"
+    uint64_t font_hash;  // FNV-1a of the font file
+    int32_t pixel_size;
+    int32_t glyph_size;  // sizeof(Glyph), so a layout change reads as stale
+    int32_t num_glyphs;
+    int32_t atlas_width;
+    int32_t atlas_height;
+};
+static const char font_cache_magic[8] = "JJFONT1";
+
+// maps a whole file read-only; NULL if it can't be opened
+static const unsigned char *map_file(const std::string &path, size_t &size)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return NULL;
+    size = st.st_size;
+    return (const unsigned char *)data;
+}
+
+static uint64_t hash_file(const std::string &path)
+{
+    size_t size;
+    const unsigned char *data = map_file(path, size);
+    if (!data)
+        return 0;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    munmap((void *)data, size);
+    return hash;
+}
+
+static std::string font_cache_path(const std::string &font_name, int pixel_size)
+{
+    size_t slash = font_name.find_last_of('/');
+    std::string base = slash == std::string::npos ? font_name : font_name.substr(slash + 1);
+    return base + "-" + std::to_string(pixel_size) + ".fontcache";
+}
+
+// Lays the ASCII set of a font at the given size out for the atlas, from
+// the baked cache when it matches the font file, otherwise with FreeType,
+// after which the cache is (re)written.
+bool Text::prepare(const std::string &font_name, int pixel_size)
+{
+    this->font_name = font_name;
+    this->pixel_size = pixel_size;
+    uint64_t font_hash = hash_file(font_name);
+    if (!font_hash)
+    {
+        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+        return false;
+    }
+    std::string cache = font_cache_path(font_name, pixel_size);
+    if (!load_cache(cache, font_hash, pixel_size))
+    {
+        if (!rasterize(font_name, pixel_size, baked))
+            return false;
+        save_cache(cache, font_hash, pixel_size, baked);
+    }
+    return true;
+}
+
+void Text::finish()
+{
+    upload(&baked[0]);
+    std::vector<unsigned char>().swap(baked);
+
+    // the rest of the atlas, below the baked glyphs, is for everything else
+    cells_top = 0;
+    for (int c = 0; c < num_glyphs; c++)
+        cells_top = std::max(cells_top, (int)ceil(glyphs[c].uv1.y * atlas_height) + 1);
+    cells.clear();
+    cell_of.clear();
+    add_cells();
+}
+
+bool Text::load_cache(const std::string &path, uint64_t font_hash, int pixel_size)
+{
+    size_t size;
+    const unsigned char *data = map_file(path, size);
+    if (!data)
+        return false;
+    FontCacheHeader header;
+    bool valid = size >= sizeof(header);
+    if (valid)
+    {
+        memcpy(&header, data, sizeof(header));
+        valid = memcmp(header.magic, font_cache_magic, sizeof(header.magic)) == 0 &&
+                header.font_hash == font_hash && header.pixel_size == pixel_size &&
+                header.glyph_size == (int32_t)sizeof(Glyph) && header.num_glyphs == num_glyphs &&
+                size == sizeof(header) + sizeof(glyphs) + (size_t)header.atlas_width * header.atlas_height;
+    }
+    if (valid)
+    {
+        memcpy(glyphs, data + sizeof(header), sizeof(glyphs));
+        atlas_width = header.atlas_width;
+        atlas_height = header.atlas_height;
+        const unsigned char *pixels = data + sizeof(header) + sizeof(glyphs);
+        baked.assign(pixels, pixels + (size_t)atlas_width * atlas_height);
+    }
+    munmap((void *)data, size);
+    return valid;
+}
+
+void Text::save_cache(const std::string &path, uint64_t font_hash, int pixel_size, const std::vector<unsigned char> &pixels)
+{
+    FontCacheHeader header;
+    memcpy(header.magic, font_cache_magic, sizeof(header.magic));
+    header.font_hash = font_hash;
+    header.pixel_size = pixel_size;
+    header.glyph_size = sizeof(Glyph);
+    header.num_glyphs = num_glyphs;
+    header.atlas_width = atlas_width;
+    header.atlas_height = atlas_height;
+
+    // written aside and renamed into place, so a reader never sees half a file
+    std::string temp = path + ".tmp";
+    FILE *file = fopen(temp.c_str(), "wb");
+    if (!file)
+        return;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(glyphs, sizeof(glyphs), 1, file) == 1 &&
+                   fwrite(&pixels[0], pixels.size(), 1, file) == 1;
+    written = fclose(file) == 0 && written;
+    if (!written || rename(temp.c_str(), path.c_str()) != 0)
+    {
+        std::cout << "ERROR::FONT_CACHE: Failed to write " << path << std::endl;
+        remove(temp.c_str());
+    }
+}
+
+// Rasterizes the ASCII set with FreeType and packs it into one image,
+// row by row, each glyph padded by a pixel so linear filtering never picks
+// up its neighbour.
+bool Text::rasterize(const std::string &font_name, int pixel_size, std::vector<unsigned char> &pixels)
+{
+    FT_Library ft;
+    // All functions return a value different than 0 whenever an error occurred
+    if (FT_Init_FreeType(&ft))
+    {
+        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+        return false;
+    }
+
+    // load font as face
+    FT_Face face;
+    if (FT_New_Face(ft, font_name.c_str(), 0, &face))
+    {
+        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+        FT_Done_FreeType(ft);
+        return false;
+    }
+    // set size to load glyphs as
+    FT_Set_Pixel_Sizes(face, 0, pixel_size);
+
+    const int padding = 1;
+    atlas_width = 512;
+    std::vector<unsigned char> bitmaps[num_glyphs];
+    glm::ivec2 place[num_glyphs];
+    int pen_x = padding, pen_y = padding, row_height = 0;
+
+    for (int c = 0; c < num_glyphs; c++)
+    {
+        Glyph &glyph = glyphs[c];
+        glyph = Glyph();
+        // Load character glyph
+        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
+        {
+            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+            continue;
+        }
+        FT_Bitmap &bitmap = face->glyph->bitmap;
+        glyph.Size = glm::ivec2(bitmap.width, bitmap.rows);
+        glyph.Bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+        // advance is in 1/64 pixels
+        glyph.Advance = face->glyph->advance.x >> 6;
+
+        bitmaps[c].resize(bitmap.width * bitmap.rows);
+        for (unsigned int row = 0; row < bitmap.rows; row++)
+            memcpy(&bitmaps[c][row * bitmap.width], bitmap.buffer + row * bitmap.pitch, bitmap.width);
+
+        if (pen_x + glyph.Size.x + padding > atlas_width)
+        {
+            pen_x = padding;
+            pen_y += row_height + padding;
+            row_height = 0;
+        }
+        place[c] = glm::ivec2(pen_x, pen_y);
+        pen_x += glyph.Size.x + padding;
+        row_height = std::max(row_height, glyph.Size.y);
+    }
+    // destroy FreeType once we're finished
+    FT_Done_Face(face);
+    FT_Done_FreeType(ft);
+
+    atlas_height = 1;
+    while (atlas_height < pen_y + row_height + padding)
+        atlas_height *= 2;
+
+    pixels.assign(atlas_width * atlas_height, 0);
+    for (int c = 0; c < num_glyphs; c++)
+    {
+        Glyph &glyph = glyphs[c];
+        for (int row = 0; row < glyph.Size.y; row++)
+            memcpy(&pixels[(place[c].y + row) * atlas_width + place[c].x], &bitmaps[c][row * glyph.Size.x], glyph.Size.x);
+        glyph.uv0 = glm::vec2(place[c]) / glm::vec2(atlas_width, atlas_height);
+        glyph.uv1 = glm::vec2(place[c] + glyph.Size) / glm::vec2(atlas_width, atlas_height);
+    }
+
+    return true;
+}
+
+void Text::upload(const unsigned char *pixels)
+{
+    // disable byte-alignment restriction
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glGenTextures(1, &atlas);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlas_width, atlas_height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels);
+    // set texture options
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// points the attributes of the bound VAO at vertices written to the stream
+// at offset
+static void point_attributes(unsigned int buffer, size_t offset)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    // position and atlas coordinate
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void *)offset);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void *)(offset + offsetof(TextVertex, r)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Text::createVAO(StreamBuffer &stream)
+{
+    this->stream = &stream;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    point_attributes(stream.ID, 0);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+}
+
+void Text::add_cells()
+{
+    for (; cells_top + GlyphBitmap::cell_size <= atlas_height; cells_top += GlyphBitmap::cell_size)
+    {
+        for (int x = 0; x + GlyphBitmap::cell_size <= atlas_width; x += GlyphBitmap::cell_size)
+        {
+            Cell cell;
+            cell.x = x;
+            cell.y = cells_top;
+            cell.state = CELL_FREE;
+            cell.codepoint = 0;
+            cell.last_used = 0;
+            cells.push_back(cell);
+        }
+    }
+}
+
+// Doubles the atlas height, keeping what is already in it. Only done from
+// update(), before this frame's text refers to any uvs.
+void Text::grow()
+{
+    grow_wanted = false;
+    if (atlas_height >= max_atlas_height)
+        return;
+    int height = atlas_height * 2;
+    std::vector<unsigned char> pixels(atlas_width * height, 0);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, GL_UNSIGNED_BYTE, &pixels[0]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlas_width, height, 0, GL_RED, GL_UNSIGNED_BYTE, &pixels[0]);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // same pixels, taller texture: every v coordinate shrinks
+    float ratio = (float)atlas_height / height;
+    for (int c = 0; c < num_glyphs; c++)
+    {
+        glyphs[c].uv0.y *= ratio;
+        glyphs[c].uv1.y *= ratio;
+    }
+    for (size_t i = 0; i < cells.size(); i++)
+    {
+        cells[i].glyph.uv0.y *= ratio;
+        cells[i].glyph.uv1.y *= ratio;
+    }
+    atlas_height = height;
+    add_cells();
+}
+
+void Text::update()
+{
+    frame++;
+    if (grow_wanted)
+        grow();
+
+    GlyphBitmap bitmap;
+    bool bound = false;
+    while (rasterizer.pop(bitmap))
+    {
+        if (!bound)
+        {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glBindTexture(GL_TEXTURE_2D, atlas);
+            bound = true;
+        }
+        // the whole cell, so nothing of the glyph it used to hold is left
+        Cell &cell = cells[bitmap.cell];
+        glTexSubImage2D(GL_TEXTURE_2D, 0, cell.x, cell.y, GlyphBitmap::cell_size, GlyphBitmap::cell_size,
+                        GL_RED, GL_UNSIGNED_BYTE, bitmap.pixels);
+        cell.glyph = bitmap.glyph;
+        cell.glyph.uv0 = glm::vec2(cell.x, cell.y) / glm::vec2(atlas_width, atlas_height);
+        cell.glyph.uv1 = glm::vec2(glm::ivec2(cell.x, cell.y) + cell.glyph.Size) / glm::vec2(atlas_width, atlas_height);
+        cell.state = CELL_READY;
+    }
+    if (bound)
+        glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// The cached glyph for a codepoint outside ASCII, or NULL if it isn't ready
+// yet, in which case it has been asked for (when there was room).
+const Glyph *Text::find(uint32_t codepoint)
+{
+    std::unordered_map<uint32_t, int>::iterator found = cell_of.find(codepoint);
+    if (found != cell_of.end())
+    {
+        Cell &cell = cells[found->second];
+        cell.last_used = frame;
+        return cell.state == CELL_READY ? &cell.glyph : NULL;
+    }
+
+    // a free cell, else the least recently drawn one that isn't in this
+    // frame's batch already; growing the atlas comes before evicting
+    int free_cell = -1, oldest = -1;
+    for (size_t i = 0; i < cells.size() && free_cell < 0; i++)
+    {
+        if (cells[i].state == CELL_FREE)
+            free_cell = i;
+        else if (cells[i].state == CELL_READY && cells[i].last_used < frame &&
+                 (oldest < 0 || cells[i].last_used < cells[oldest].last_used))
+            oldest = i;
+    }
+    int cell = free_cell;
+    if (cell < 0)
+    {
+        if (atlas_height < max_atlas_height)
+        {
+            grow_wanted = true;
+            return NULL;
+        }
+        cell = oldest;
+    }
+    if (cell < 0)
+        return NULL;
+
+    rasterizer.start(font_name, pixel_size);
+    if (!rasterizer.request(codepoint, cell))
+        return NULL;
+    if (cells[cell].state == CELL_READY)
+        cell_of.erase(cells[cell].codepoint);
+    cells[cell].state = CELL_PENDING;
+    cells[cell].codepoint = codepoint;
+    cells[cell].last_used = frame;
+    cell_of[codepoint] = cell;
+    return NULL;
+}
+
+// next codepoint of a UTF-8 string, U+FFFD for malformed bytes
+static uint32_t next_codepoint(const unsigned char *&p)
+{
+    uint32_t c = *p++;
+    if (c < 0x80)
+        return c;
+    int extra = (c >> 5) == 0x6 ? 1 : (c >> 4) == 0xe ? 2 : (c >> 3) == 0x1e ? 3 : -1;
+    if (extra < 0)
+        return 0xfffd;
+    c &= 0x3f >> extra;
+    for (int i = 0; i < extra; i++, p++)
+    {
+        if ((*p & 0xc0) != 0x80)
+            return 0xfffd;
+        c = (c << 6) | (*p & 0x3f);
+    }
+    return c;
+}
+
+bool Text::add(const char *text, float x, float y, float scale, glm::vec3 color)
+{
+    bool complete = true;
+    const unsigned char *p = (const unsigned char *)text;
+    // iterate through all characters
+    while (*p)
+    {
+        uint32_t codepoint = next_codepoint(p);
+        const Glyph *glyph = codepoint < num_glyphs ? &glyphs[codepoint] : find(codepoint);
+        if (!glyph)
+        {
+            glyph = &glyphs['?'];
+            complete = false;
+        }
+        const Glyph &ch = *glyph;
+
+        float xpos = x + ch.Bearing.x * scale;
+        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
+
+        float w = ch.Size.x * scale;
+        float h = ch.Size.y * scale;
+        TextVertex quad[6] = {
+            {xpos, ypos + h, ch.uv0.x, ch.uv0.y, color.r, color.g, color.b},
+            {xpos, ypos, ch.uv0.x, ch.uv1.y, color.r, color.g, color.b},
+            {xpos + w, ypos, ch.uv1.x, ch.uv1.y, color.r, color.g, color.b},
+
+            {xpos, ypos + h, ch.uv0.x, ch.uv0.y, color.r, color.g, color.b},
+            {xpos + w, ypos, ch.uv1.x, ch.uv1.y, color.r, color.g, color.b},
+            {xpos + w, ypos + h, ch.uv1.x, ch.uv0.y, color.r, color.g, color.b}};
+        vertices.insert(vertices.end(), quad, quad + 6);
+        // now advance cursors for next glyph
+        x += ch.Advance * scale;
+    }
+    return complete;
+}
+
+void Text::draw(Shader &shader)
+{
+    if (vertices.empty())
+        return;
+    shader.use();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    size_t offset = stream->write(&vertices[0], vertices.size() * sizeof(TextVertex));
+    glBindVertexArray(VAO);
+    point_attributes(stream->ID, offset);
+    glDrawArrays(GL_TRIANGLES, 0, vertices.size());
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    vertices.clear();
+}
+
+GlyphRasterizer::~GlyphRasterizer()
+{
+    if (!started)
+        return;
+    stopping = true;
+    worker.join();
+}
+
+void GlyphRasterizer::start(const std::string &font_name, int pixel_size)
+{
+    if (started)
+        return;
+    this->font_name = font_name;
+    this->pixel_size = pixel_size;
+    started = true;
+    worker = std::thread(&GlyphRasterizer::run, this);
+}
+
+bool GlyphRasterizer::request(uint32_t codepoint, int cell)
+{
+    Request r = {codepoint, cell};
+    return requests.push(r);
+}
+
+void GlyphRasterizer::run()
+{
+    // FreeType objects aren't shared between threads, so this one has its own
+    FT_Library ft;
+    FT_Face face;
+    if (FT_Init_FreeType(&ft))
+    {
+        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+        return;
+    }
+    if (FT_New_Face(ft, font_name.c_str(), 0, &face))
+    {
+        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+        FT_Done_FreeType(ft);
+        return;
+    }
+    FT_Set_Pixel_Sizes(face, 0, pixel_size);
+
+    GlyphBitmap bitmap;
+    Request request;
+    while (!stopping)
+    {
+        if (!requests.pop(request))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            continue;
+        }
+        bitmap = GlyphBitmap();
+        bitmap.codepoint = request.codepoint;
+        bitmap.cell = request.cell;
+        // a glyph the font can't render stays empty, so it isn't asked for again
+        if (FT_Load_Char(face, request.codepoint, FT_LOAD_RENDER) == 0)
+        {
+            FT_Bitmap &b = face->glyph->bitmap;
+            // cropped to leave at least a pixel of gap to the next cell
+            int width = std::min((int)b.width, GlyphBitmap::cell_size - 1);
+            int rows = std::min((int)b.rows, GlyphBitmap::cell_size - 1);
+            for (int row = 0; row < rows; row++)
+                memcpy(&bitmap.pixels[row * GlyphBitmap::cell_size], b.buffer + row * b.pitch, width);
+            bitmap.glyph.Size = glm::ivec2(width, rows);
+            bitmap.glyph.Bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+            bitmap.glyph.Advance = face->glyph->advance.x >> 6;
+        }
+        while (!results.push(bitmap))
+        {
+            if (stopping)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    FT_Done_Face(face);
+    FT_Done_FreeType(ft);
+}
@@ -0,0 +1,151 @@
+#include "main.h"
+#include "shader.h"
+#include "stream.h"
+#include "sim/spsc_ring.h"
+
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+#ifndef TEXT_H
+#define TEXT_H
+
+/// Where a glyph sits in the atlas and how to place it on the baseline
+struct Glyph
+{
+    glm::ivec2 Size;    // Size of glyph
+    glm::ivec2 Bearing; // Offset from baseline to left/top of glyph
+    float Advance;      // Horizontal offset to advance to next glyph, in pixels
+    glm::vec2 uv0;      // top left corner in the atlas
+    glm::vec2 uv1;      // bottom right corner
+};
+
+// One vertex of a glyph quad; text.vs reads position, atlas coordinate and
+// colour, so strings of any colour go into the same batch.
+struct TextVertex
+{
+    float x;
+    float y;
+    float u;
+    float v;
+    float r;
+    float g;
+    float b;
+};
+
+// A glyph outside ASCII, rasterized off the frame thread into a square
+// cell of the atlas.
+struct GlyphBitmap
+{
+    static const int cell_size = 64;
+
+    uint32_t codepoint;
+    int cell;
+    Glyph glyph; // Size, Bearing and Advance; the uvs are the cell's
+    unsigned char pixels[cell_size * cell_size];
+};
+
+// Owns a FreeType face of its own and rasterizes requested codepoints on a
+// worker thread, handing bitmaps back through lock-free rings. Started on
+// the first glyph that isn't baked, so ASCII-only runs never spawn it.
+class GlyphRasterizer
+{
+public:
+    GlyphRasterizer() : started(false), stopping(false) {}
+    ~GlyphRasterizer();
+
+    void start(const std::string &font_name, int pixel_size);
+    // neither blocks; false when the ring is full (or empty)
+    bool request(uint32_t codepoint, int cell);
+    bool pop(GlyphBitmap &bitmap) { return results.pop(bitmap); }
+
+private:
+    struct Request
+    {
+        uint32_t codepoint;
+        int cell;
+    };
+
+    void run();
+
+    std::string font_name;
+    int pixel_size;
+    bool started;
+    std::atomic<bool> stopping;
+    std::thread worker;
+    SpscRing<Request, 64> requests;
+    SpscRing<GlyphBitmap, 16> results;
+};
+
+// The glyphs of one face in a single red-channel atlas. ASCII is baked into
+// the top of the atlas when the font loads; any other codepoint gets a cell
+// below it the first time it is drawn, and a '?' stands in until the worker
+// has rasterized it. The atlas grows up to max_atlas_height, after which the
+// least recently drawn cell is reused, so memory stays bounded.
+// add() appends a string's quads to a batch and draw() renders everything
+// added since the last draw with one buffer upload and one draw call.
+class Text
+{
+public:
+    static const int num_glyphs = 128;
+    static const int max_atlas_height = 2048;
+
+    unsigned int atlas;
+    int atlas_width;
+    int atlas_height;
+    Glyph glyphs[num_glyphs];
+
+    // touches no GL, so it can run on another thread; finish() then
+    // uploads the atlas on the GL thread
+    bool prepare(const std::string &font_name, int pixel_size);
+    void finish();
+    // the batch is streamed through `stream` on every draw()
+    void createVAO(StreamBuffer &stream);
+    // once per frame, before any add(): uploads finished glyphs
+    void update();
+    // UTF-8; false if a placeholder was drawn for a glyph still on its way
+    bool add(const char *text, float x, float y, float scale, glm::vec3 color);
+    bool add(const std::string &text, float x, float y, float scale, glm::vec3 color) { return add(text.c_str(), x, y, scale, color); }
+    void draw(Shader &shader);
+
+private:
+    enum CellState
+    {
+        CELL_FREE,
+        CELL_PENDING,
+        CELL_READY,
+    };
+    struct Cell
+    {
+        int x; // top left, in atlas pixels
+        int y;
+        CellState state;
+        uint32_t codepoint;
+        uint64_t last_used; // frame
+        Glyph glyph;
+    };
+
+    bool load_cache(const std::string &path, uint64_t font_hash, int pixel_size);
+    void save_cache(const std::string &path, uint64_t font_hash, int pixel_size, const std::vector<unsigned char> &pixels);
+    bool rasterize(const std::string &font_name, int pixel_size, std::vector<unsigned char> &pixels);
+    void upload(const unsigned char *pixels);
+    const Glyph *find(uint32_t codepoint);
+    void add_cells();
+    void grow();
+
+    unsigned int VAO;
+    StreamBuffer *stream;
+    std::vector<TextVertex> vertices;
+
+    std::string font_name;
+    int pixel_size;
+    uint64_t frame = 0;
+    bool grow_wanted = false;
+    int cells_top;             // first atlas row not yet cut into cells
+    std::vector<Cell> cells;
+    std::unordered_map<uint32_t, int> cell_of; // codepoint -> cell
+    GlyphRasterizer rasterizer;
+    std::vector<unsigned char> baked; // the ASCII atlas, between prepare() and finish()
+};
+
+#endif
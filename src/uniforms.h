@@ -0,0 +1,30 @@
+#include "main.h"
+#include "shader.h"
+
+#ifndef UNIFORMS_H
+#define UNIFORMS_H
+
+// Ids of the uniforms set while drawing, hashed at compile time so the frame
+// loop never touches a uniform name.
+constexpr UniformId U_TRANSFORM = uniform_id("transform");
+constexpr UniformId U_BLUR = uniform_id("blur");
+constexpr UniformId U_COL = uniform_id("col");
+constexpr UniformId U_CIRCLE = uniform_id("circle");
+constexpr UniformId U_SHINE = uniform_id("shine");
+constexpr UniformId U_SOURCE = uniform_id("source");
+constexpr UniformId U_RADIUS = uniform_id("radius");
+constexpr UniformId U_SCENE = uniform_id("scene");
+constexpr UniformId U_BLOOM_BLUR = uniform_id("bloomBlur");
+constexpr UniformId U_BLOOM = uniform_id("bloom");
+constexpr UniformId U_HUD = uniform_id("hud");
+
+// The "Frame" uniform block (std140), shared by every shader that declares
+// it and uploaded once per frame.
+struct FrameUniforms
+{
+    glm::mat4 projection; // text, in screen pixels
+    float exposure;       // tone mapping
+    float pad[3];
+};
+
+#endif